@@ -0,0 +1,146 @@
+//
+// allocator_wrapper.h
+// ~~~~~~~~~~~~~~~~~~~
+// Wraps a function object so that it is associated with an allocator.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_ALLOCATOR_WRAPPER_H
+#define EXECUTORS_EXPERIMENTAL_BITS_ALLOCATOR_WRAPPER_H
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+template <class _T, class _Allocator>
+inline allocator_wrapper<_T, _Allocator>::allocator_wrapper(_T __t, const _Allocator& __a)
+  : _M_wrapped(std::move(__t)), _M_allocator(__a)
+{
+}
+
+template <class _T, class _Allocator> template <class _U, class _OtherAllocator>
+inline allocator_wrapper<_T, _Allocator>::allocator_wrapper(const allocator_wrapper<_U, _OtherAllocator>& __w)
+  : _M_wrapped(__w._M_wrapped), _M_allocator(__w._M_allocator)
+{
+}
+
+template <class _T, class _Allocator> template <class _U, class _OtherAllocator>
+inline allocator_wrapper<_T, _Allocator>::allocator_wrapper(allocator_wrapper<_U, _OtherAllocator>&& __w)
+  : _M_wrapped(std::move(__w._M_wrapped)), _M_allocator(std::move(__w._M_allocator))
+{
+}
+
+template <class _T, class _Allocator>
+inline allocator_wrapper<_T, _Allocator>::~allocator_wrapper()
+{
+}
+
+template <class _T, class _Allocator>
+inline _T& allocator_wrapper<_T, _Allocator>::unwrap() noexcept
+{
+  return _M_wrapped;
+}
+
+template <class _T, class _Allocator>
+inline const _T& allocator_wrapper<_T, _Allocator>::unwrap() const noexcept
+{
+  return _M_wrapped;
+}
+
+template <class _T, class _Allocator>
+inline typename allocator_wrapper<_T, _Allocator>::allocator_type
+allocator_wrapper<_T, _Allocator>::get_allocator() const noexcept
+{
+  return _M_allocator;
+}
+
+template <class _T, class _Allocator> template <class... _Args>
+inline typename result_of<_T&(_Args&&...)>::type
+allocator_wrapper<_T, _Allocator>::operator()(_Args&&... __args) &
+{
+  return _M_wrapped(forward<_Args>(__args)...);
+}
+
+template <class _T, class _Allocator> template <class... _Args>
+inline typename result_of<const _T&(_Args&&...)>::type
+allocator_wrapper<_T, _Allocator>::operator()(_Args&&... __args) const &
+{
+  return _M_wrapped(forward<_Args>(__args)...);
+}
+
+template <class _T, class _Allocator> template <class... _Args>
+inline typename result_of<_T&&(_Args&&...)>::type
+allocator_wrapper<_T, _Allocator>::operator()(_Args&&... __args) &&
+{
+  return std::move(_M_wrapped)(forward<_Args>(__args)...);
+}
+
+template <class _T, class _Allocator> template <class... _Args>
+inline typename result_of<const _T&&(_Args&&...)>::type
+allocator_wrapper<_T, _Allocator>::operator()(_Args&&... __args) const &&
+{
+  return std::move(_M_wrapped)(forward<_Args>(__args)...);
+}
+
+template <class _T, class _Allocator, class _Signature>
+struct handler_type<allocator_wrapper<_T, _Allocator>, _Signature>
+{
+  typedef allocator_wrapper<handler_type_t<_T, _Signature>, _Allocator> type;
+};
+
+template <class _T, class _Allocator>
+class async_result<allocator_wrapper<_T, _Allocator>>
+{
+public:
+  typedef typename async_result<_T>::type type;
+  explicit async_result(allocator_wrapper<_T, _Allocator>& __w) : _M_wrapped(__w.unwrap()) {}
+  type get() { return _M_wrapped.get(); }
+
+private:
+  async_result<_T> _M_wrapped;
+};
+
+template <class _T, class _Allocator, class _Executor>
+struct associated_executor<allocator_wrapper<_T, _Allocator>, _Executor>
+{
+  typedef typename associated_executor<_T, _Executor>::type type;
+
+  static type get(const allocator_wrapper<_T, _Allocator>& __w, const _Executor& __e = _Executor()) noexcept
+  {
+    return associated_executor<_T, _Executor>::get(__w.unwrap(), __e);
+  }
+};
+
+template <class _T, class _Allocator, class... _Args>
+struct continuation_of<allocator_wrapper<_T, _Allocator>(_Args...)>
+{
+  typedef continuation_of<
+    typename allocator_wrapper<_T, _Allocator>::wrapped_type(_Args...)> _Wrapped_continuation_of;
+
+  typedef typename _Wrapped_continuation_of::signature signature;
+
+  template <class _C>
+  static auto chain(allocator_wrapper<_T, _Allocator>&& __f, _C&& __c)
+  {
+    return (wrap)(allocator_arg, __f.get_allocator(),
+      _Wrapped_continuation_of::chain(std::move(__f.unwrap()),
+        forward<_C>(__c)));
+  }
+};
+
+template <class _Allocator, class _T>
+inline allocator_wrapper<typename decay<_T>::type, _Allocator>
+  wrap(allocator_arg_t, const _Allocator& __a, _T&& __t)
+{
+  return allocator_wrapper<typename decay<_T>::type, _Allocator>(forward<_T>(__t), __a);
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
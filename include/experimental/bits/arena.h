@@ -0,0 +1,172 @@
+//
+// arena.h
+// ~~~~~~~
+// Bump allocator for the operations of an asynchronous chain.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_ARENA_H
+#define EXECUTORS_EXPERIMENTAL_BITS_ARENA_H
+
+#include <cstdint>
+#include <new>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+struct arena::_Block
+{
+  _Block* _M_next;
+  size_t _M_size;
+
+  char* _Begin() noexcept { return reinterpret_cast<char*>(this + 1); }
+  char* _End() noexcept { return _Begin() + _M_size; }
+};
+
+inline arena::arena(size_t __block_size)
+  : _M_block_size(__block_size), _M_first(nullptr), _M_current(nullptr),
+    _M_top(nullptr), _M_end(nullptr), _M_allocations(0)
+{
+}
+
+inline arena::~arena()
+{
+  while (_Block* __b = _M_first)
+  {
+    _M_first = __b->_M_next;
+    ::operator delete(__b);
+  }
+}
+
+inline arena::allocator_type arena::get_allocator() noexcept
+{
+  return allocator_type(*this);
+}
+
+inline void* arena::allocate(size_t __size, size_t __alignment)
+{
+  for (;;)
+  {
+    if (_M_top)
+    {
+      uintptr_t __addr = reinterpret_cast<uintptr_t>(_M_top);
+      char* __p = _M_top + ((__alignment - __addr % __alignment) % __alignment);
+      if (__p <= _M_end && __size <= static_cast<size_t>(_M_end - __p))
+      {
+        _M_top = __p + __size;
+        ++_M_allocations;
+        return __p;
+      }
+    }
+
+    // Move on to the next block, reusing one from an earlier pass through the
+    // arena if it is large enough.
+    _Block* __next = _M_current ? _M_current->_M_next : _M_first;
+    if (!__next || __next->_M_size < __size + __alignment)
+    {
+      size_t __block_size = __size + __alignment > _M_block_size
+        ? __size + __alignment : _M_block_size;
+      _Block* __b = static_cast<_Block*>(::operator new(sizeof(_Block) + __block_size));
+      __b->_M_size = __block_size;
+      __b->_M_next = __next;
+      if (_M_current)
+        _M_current->_M_next = __b;
+      else
+        _M_first = __b;
+      __next = __b;
+    }
+
+    _M_current = __next;
+    _M_top = __next->_Begin();
+    _M_end = __next->_End();
+  }
+}
+
+inline void arena::deallocate(void* __p, size_t __size) noexcept
+{
+  if (--_M_allocations == 0)
+    _Rewind();
+  else if (static_cast<char*>(__p) + __size == _M_top)
+    _M_top = static_cast<char*>(__p);
+}
+
+inline size_t arena::allocations() const noexcept
+{
+  return _M_allocations;
+}
+
+inline void arena::_Rewind() noexcept
+{
+  _M_current = _M_first;
+  _M_top = _M_first ? _M_first->_Begin() : nullptr;
+  _M_end = _M_first ? _M_first->_End() : nullptr;
+}
+
+template <class _T>
+inline arena_allocator<_T>::arena_allocator(arena& __a) noexcept
+  : _M_arena(&__a)
+{
+}
+
+template <class _T> template <class _U>
+inline arena_allocator<_T>::arena_allocator(const arena_allocator<_U>& __other) noexcept
+  : _M_arena(&__other.get_arena())
+{
+}
+
+template <class _T>
+inline _T* arena_allocator<_T>::allocate(size_t __n)
+{
+  return static_cast<_T*>(_M_arena->allocate(sizeof(_T) * __n, alignof(_T)));
+}
+
+template <class _T>
+inline void arena_allocator<_T>::deallocate(_T* __p, size_t __n) noexcept
+{
+  _M_arena->deallocate(__p, sizeof(_T) * __n);
+}
+
+template <class _T>
+inline arena& arena_allocator<_T>::get_arena() const noexcept
+{
+  return *_M_arena;
+}
+
+inline arena_allocator<void>::arena_allocator(arena& __a) noexcept
+  : _M_arena(&__a)
+{
+}
+
+template <class _U>
+inline arena_allocator<void>::arena_allocator(const arena_allocator<_U>& __other) noexcept
+  : _M_arena(&__other.get_arena())
+{
+}
+
+inline arena& arena_allocator<void>::get_arena() const noexcept
+{
+  return *_M_arena;
+}
+
+template <class _T, class _U>
+inline bool operator==(const arena_allocator<_T>& __a, const arena_allocator<_U>& __b) noexcept
+{
+  return &__a.get_arena() == &__b.get_arena();
+}
+
+template <class _T, class _U>
+inline bool operator!=(const arena_allocator<_T>& __a, const arena_allocator<_U>& __b) noexcept
+{
+  return &__a.get_arena() != &__b.get_arena();
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
@@ -0,0 +1,213 @@
+//
+// cpu_topology.h
+// ~~~~~~~~~~~~~~
+// Processor topology discovery and thread placement.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_CPU_TOPOLOGY_H
+#define EXECUTORS_EXPERIMENTAL_BITS_CPU_TOPOLOGY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+#include <experimental/bits/scheduler_options.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// Describes the processors available to the program, grouped by NUMA node.
+// Where the topology cannot be discovered, all processors are assumed to be
+// separate physical cores on a single node.
+
+class __cpu_topology
+{
+public:
+  static const __cpu_topology& _Instance()
+  {
+    static const __cpu_topology __t;
+    return __t;
+  }
+
+  size_t _Num_nodes() const
+  {
+    return _M_nodes.size();
+  }
+
+  const vector<unsigned>& _Node_cpus(size_t __node) const
+  {
+    return _M_nodes[__node];
+  }
+
+  const vector<unsigned>& _Physical_cores() const
+  {
+    return _M_cores;
+  }
+
+  size_t _Node_of(unsigned __cpu) const
+  {
+    return __cpu < _M_cpu_nodes.size() ? _M_cpu_nodes[__cpu] : 0;
+  }
+
+  // The node of the processor the calling thread is currently running on.
+  size_t _Current_node() const
+  {
+    if (_M_nodes.size() <= 1)
+      return 0;
+#if defined(__linux__)
+    int __cpu = sched_getcpu();
+    return __cpu < 0 ? 0 : _Node_of(static_cast<unsigned>(__cpu));
+#else
+    return 0;
+#endif
+  }
+
+  // Restrict the calling thread to the processors in [__first, __last).
+  // Placement is a hint, so failure is ignored and the thread continues to run
+  // unpinned.
+  static void _Bind_this_thread(const unsigned* __first, const unsigned* __last)
+  {
+#if defined(__linux__)
+    if (__first == __last)
+      return;
+    cpu_set_t __set;
+    CPU_ZERO(&__set);
+    for (; __first != __last; ++__first)
+      if (*__first < CPU_SETSIZE)
+        CPU_SET(*__first, &__set);
+    pthread_setaffinity_np(pthread_self(), sizeof(__set), &__set);
+#else
+    (void)__first;
+    (void)__last;
+#endif
+  }
+
+  static void _Bind_this_thread(const vector<unsigned>& __cpus)
+  {
+    _Bind_this_thread(__cpus.data(), __cpus.data() + __cpus.size());
+  }
+
+  static void _Bind_this_thread(unsigned __cpu)
+  {
+    _Bind_this_thread(&__cpu, &__cpu + 1);
+  }
+
+  // Apply a placement policy to the calling thread, which is the thread with
+  // the given index in a pool.
+  void _Place_this_thread(const scheduler_options& __options, size_t __index) const
+  {
+    switch (__options.placement)
+    {
+    case thread_placement::cpu_list:
+      if (!__options.cpus.empty())
+        _Bind_this_thread(__options.cpus[__index % __options.cpus.size()]);
+      break;
+    case thread_placement::physical_core:
+      if (!_M_cores.empty())
+        _Bind_this_thread(_M_cores[__index % _M_cores.size()]);
+      break;
+    case thread_placement::numa_node:
+      if (_M_nodes.size() > 1)
+        _Bind_this_thread(_M_nodes[__index % _M_nodes.size()]);
+      break;
+    default:
+      break;
+    }
+  }
+
+private:
+  __cpu_topology()
+  {
+#if defined(__linux__)
+    // Node numbers may have gaps, and memory-only nodes have no processors, so
+    // the nodes are taken from the kernel's list rather than counted up from
+    // zero. Nodes are numbered densely here, in the kernel's order.
+    vector<unsigned> __node_ids = _Read_cpu_list("/sys/devices/system/node/has_cpu");
+    if (__node_ids.empty())
+      __node_ids = _Read_cpu_list("/sys/devices/system/node/online");
+    for (unsigned __id: __node_ids)
+    {
+      vector<unsigned> __cpus = _Read_cpu_list(
+        "/sys/devices/system/node/node" + to_string(__id) + "/cpulist");
+      if (__cpus.empty())
+        continue;
+      for (unsigned __cpu: __cpus)
+      {
+        if (_M_cpu_nodes.size() <= __cpu)
+          _M_cpu_nodes.resize(__cpu + 1, 0);
+        _M_cpu_nodes[__cpu] = _M_nodes.size();
+      }
+      _M_nodes.push_back(std::move(__cpus));
+    }
+
+    // A physical core is represented by the first of its hardware threads.
+    for (unsigned __cpu: _Read_cpu_list("/sys/devices/system/cpu/online"))
+    {
+      vector<unsigned> __siblings = _Read_cpu_list("/sys/devices/system/cpu/cpu"
+        + to_string(__cpu) + "/topology/thread_siblings_list");
+      if (__siblings.empty() || __siblings.front() == __cpu)
+        _M_cores.push_back(__cpu);
+    }
+#endif
+
+    if (_M_nodes.empty())
+    {
+      unsigned __n = thread::hardware_concurrency();
+      vector<unsigned> __cpus;
+      for (unsigned __cpu = 0; __cpu < __n; ++__cpu)
+        __cpus.push_back(__cpu);
+      _M_nodes.push_back(__cpus);
+    }
+
+    if (_M_cores.empty())
+      _M_cores = _M_nodes.front();
+  }
+
+  // Parse a kernel cpu or node list such as "0-3,8,10-11".
+  static vector<unsigned> _Read_cpu_list(const string& __path)
+  {
+    vector<unsigned> __cpus;
+    ifstream __file(__path);
+    string __range;
+    while (getline(__file, __range, ','))
+    {
+      unsigned __first = 0, __last = 0;
+      char __dash = 0;
+      istringstream __is(__range);
+      if (!(__is >> __first))
+        break;
+      if (__is >> __dash >> __last && __dash == '-')
+        for (unsigned __cpu = __first; __cpu <= __last; ++__cpu)
+          __cpus.push_back(__cpu);
+      else
+        __cpus.push_back(__first);
+    }
+    sort(__cpus.begin(), __cpus.end());
+    return __cpus;
+  }
+
+  vector<vector<unsigned>> _M_nodes;
+  vector<unsigned> _M_cores;
+  vector<size_t> _M_cpu_nodes;
+};
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
@@ -0,0 +1,164 @@
+//
+// deadline_scheduler.h
+// ~~~~~~~~~~~~~~~~~~~~
+// Deadline scheduler implementation.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_DEADLINE_SCHEDULER_H
+#define EXECUTORS_EXPERIMENTAL_BITS_DEADLINE_SCHEDULER_H
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+inline deadline_scheduler::deadline_scheduler()
+{
+}
+
+inline deadline_scheduler::~deadline_scheduler()
+{
+}
+
+inline deadline_scheduler::executor_type deadline_scheduler::get_executor() const noexcept
+{
+  return executor_type(const_cast<deadline_scheduler*>(this),
+    (chrono::steady_clock::time_point::max)());
+}
+
+inline deadline_scheduler::executor_type deadline_scheduler::get_executor(
+  const chrono::steady_clock::time_point& __deadline) const noexcept
+{
+  return executor_type(const_cast<deadline_scheduler*>(this), __deadline);
+}
+
+inline uint64_t deadline_scheduler::deadline_misses() const noexcept
+{
+  return _Deadline_misses();
+}
+
+inline size_t deadline_scheduler::run()
+{
+  return _Run();
+}
+
+template <class _Rep, class _Period>
+size_t deadline_scheduler::run_for(
+  const chrono::duration<_Rep, _Period>& __rel_time)
+{
+  return this->run_until(chrono::steady_clock::now() + __rel_time);
+}
+
+template <class _Clock, class _Duration>
+size_t deadline_scheduler::run_until(
+  const chrono::time_point<_Clock, _Duration>& __abs_time)
+{
+  return this->_Run_until(__abs_time, (numeric_limits<size_t>::max)());
+}
+
+inline size_t deadline_scheduler::run_one()
+{
+  return _Run_one();
+}
+
+template <class _Rep, class _Period>
+size_t deadline_scheduler::run_one_for(
+  const chrono::duration<_Rep, _Period>& __rel_time)
+{
+  return this->run_one_until(chrono::steady_clock::now() + __rel_time);
+}
+
+template <class _Clock, class _Duration>
+size_t deadline_scheduler::run_one_until(
+  const chrono::time_point<_Clock, _Duration>& __abs_time)
+{
+  return this->_Run_until(__abs_time, 1);
+}
+
+inline size_t deadline_scheduler::poll()
+{
+  return _Poll();
+}
+
+inline size_t deadline_scheduler::poll_one()
+{
+  return _Poll(1);
+}
+
+inline void deadline_scheduler::stop()
+{
+  _Stop();
+}
+
+inline bool deadline_scheduler::stopped() const
+{
+  return _Stopped();
+}
+
+inline void deadline_scheduler::restart()
+{
+  _Restart();
+}
+
+inline bool deadline_scheduler::executor_type::running_in_this_thread() const noexcept
+{
+  return _M_scheduler->_Running_in_this_thread();
+}
+
+inline deadline_scheduler& deadline_scheduler::executor_type::context() noexcept
+{
+  return *_M_scheduler;
+}
+
+inline chrono::steady_clock::time_point deadline_scheduler::executor_type::deadline() const noexcept
+{
+  return _M_deadline;
+}
+
+inline void deadline_scheduler::executor_type::on_work_started() noexcept
+{
+  _M_scheduler->_Work_started();
+}
+
+inline void deadline_scheduler::executor_type::on_work_finished() noexcept
+{
+  _M_scheduler->_Work_finished();
+}
+
+template <class _Func, class _Alloc>
+void deadline_scheduler::executor_type::dispatch(_Func&& __f, const _Alloc& __a)
+{
+  _M_scheduler->_Dispatch(_M_deadline, forward<_Func>(__f), __a);
+}
+
+template <class _Func, class _Alloc>
+void deadline_scheduler::executor_type::post(_Func&& __f, const _Alloc& __a)
+{
+  _M_scheduler->_Post(_M_deadline, forward<_Func>(__f), __a);
+}
+
+template <class _Func, class _Alloc>
+void deadline_scheduler::executor_type::defer(_Func&& __f, const _Alloc& __a)
+{
+  _M_scheduler->_Post(_M_deadline, forward<_Func>(__f), __a);
+}
+
+inline bool operator==(const deadline_scheduler::executor_type& __a, const deadline_scheduler::executor_type& __b) noexcept
+{
+  return __a._M_scheduler == __b._M_scheduler && __a._M_deadline == __b._M_deadline;
+}
+
+inline bool operator!=(const deadline_scheduler::executor_type& __a, const deadline_scheduler::executor_type& __b) noexcept
+{
+  return !(__a == __b);
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
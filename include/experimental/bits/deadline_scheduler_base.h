@@ -0,0 +1,162 @@
+//
+// deadline_scheduler_base.h
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// Thread-safe scheduler that runs operations in deadline order.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_DEADLINE_SCHEDULER_BASE_H
+#define EXECUTORS_EXPERIMENTAL_BITS_DEADLINE_SCHEDULER_BASE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <experimental/timer>
+#include <experimental/bits/operation.h>
+#include <experimental/bits/queued_scheduler_base.h>
+#include <experimental/bits/small_block_recycler.h>
+#include <experimental/bits/timer_queue.h>
+#include <experimental/bits/wait_op.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+typedef __timer_queue<chrono::steady_clock,
+  timer_traits<chrono::steady_clock>> __deadline_queue;
+
+class __deadline_op_base
+  : public __wait_op_base
+{
+public:
+  __deadline_queue::__per_timer_data _M_timer;
+};
+
+template <class _Func, class _Allocator>
+class __deadline_op
+  : public __deadline_op_base
+{
+public:
+  __deadline_op(const __deadline_op&) = delete;
+  __deadline_op& operator=(const __deadline_op&) = delete;
+
+  template <class _F> __deadline_op(_F&& __f, const _Allocator& __a)
+    : _M_func(forward<_F>(__f)), _M_allocator(__a)
+  {
+  }
+
+  virtual void _Complete()
+  {
+    auto __op(_Adopt_small_block(_M_allocator, this));
+    _Func __tmp(std::move(_M_func));
+    __op.reset();
+    std::move(__tmp)();
+  }
+
+  virtual void _Destroy()
+  {
+    _Adopt_small_block(_M_allocator, this);
+  }
+
+private:
+  _Func _M_func;
+  _Allocator _M_allocator;
+};
+
+// Operations with a deadline are ordered using the same heap as timers, with
+// each operation carrying its own heap entry. Operations without a deadline
+// are queued in FIFO order and run only when no operation with a deadline is
+// waiting.
+
+class __deadline_queue_policy
+{
+public:
+  typedef chrono::steady_clock::time_point _Key;
+
+  template <class _Func, class _Alloc>
+  using _Op = __deadline_op<_Func, _Alloc>;
+
+  __deadline_queue_policy()
+    : _M_missed(0)
+  {
+  }
+
+  ~__deadline_queue_policy()
+  {
+    // Operations own their heap entries, so they must be removed from the
+    // heap before they are destroyed.
+    __op_queue<__operation> __ops;
+    _M_deadlines._Get_all_timers(__ops);
+  }
+
+  uint64_t _Deadline_misses() const noexcept
+  {
+    return _M_missed.load(memory_order_relaxed);
+  }
+
+  void _Push(const _Key& __deadline, __operation* __op)
+  {
+    if (__deadline == (_Key::max)())
+    {
+      _M_best_effort._Push(__op);
+    }
+    else
+    {
+      __deadline_op_base* __d = static_cast<__deadline_op_base*>(__op);
+      _M_deadlines._Enqueue_timer(__deadline, __d->_M_timer, __d);
+    }
+  }
+
+  // Remove the operation with the earliest deadline, or the oldest operation
+  // without one.
+  __operation* _Pop(_Key& __deadline)
+  {
+    __deadline = (_Key::max)();
+    __op_queue<__operation> __ops;
+    __operation* __op;
+    if (_M_deadlines._Get_first_timer(__ops, __deadline))
+    {
+      __op = __ops._Front();
+      __ops._Pop();
+    }
+    else
+    {
+      __op = _M_best_effort._Front();
+      _M_best_effort._Pop();
+    }
+    return __op;
+  }
+
+  // Record whether the operation finished after its deadline.
+  void _Completed(const _Key& __deadline)
+  {
+    if (__deadline != (_Key::max)() && __deadline < chrono::steady_clock::now())
+      _M_missed.fetch_add(1, memory_order_relaxed);
+  }
+
+private:
+  __deadline_queue _M_deadlines;
+  __op_queue<__operation> _M_best_effort;
+  atomic<uint64_t> _M_missed;
+};
+
+class __deadline_scheduler_base
+  : public __queued_scheduler_base<__deadline_queue_policy>
+{
+public:
+  uint64_t _Deadline_misses() const noexcept
+  {
+    return _Queue_policy()._Deadline_misses();
+  }
+};
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
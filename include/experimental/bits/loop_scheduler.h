@@ -27,6 +27,14 @@ inline loop_scheduler::loop_scheduler(size_t __concurrency_hint)
 {
 }
 
+inline loop_scheduler::loop_scheduler(size_t __concurrency_hint,
+    const scheduler_options& __options)
+  : __scheduler(__concurrency_hint, __options)
+{
+  if (__options.run_timers)
+    _Set_timers(make_service<__reactor>(*this, static_cast<__reactor_host&>(*this)));
+}
+
 inline loop_scheduler::~loop_scheduler()
 {
 }
@@ -99,6 +107,11 @@ inline void loop_scheduler::restart()
   _Restart();
 }
 
+inline scheduler_statistics loop_scheduler::statistics() const
+{
+  return _Statistics();
+}
+
 inline bool loop_scheduler::executor_type::running_in_this_thread() const noexcept
 {
   return _M_scheduler->_Running_in_this_thread();
@@ -137,6 +150,18 @@ void loop_scheduler::executor_type::defer(_Func&& __f, const _Alloc& __a)
   _M_scheduler->_Defer(forward<_Func>(__f), __a);
 }
 
+template <class _InputIterator, class _Alloc>
+void loop_scheduler::executor_type::post_range(_InputIterator __first, _InputIterator __last, const _Alloc& __a)
+{
+  _M_scheduler->_Post_range(__first, __last, __a);
+}
+
+template <class _Alloc, class... _Funcs>
+void loop_scheduler::executor_type::post_each(const _Alloc& __a, _Funcs&&... __fs)
+{
+  _M_scheduler->_Post_each(__a, forward<_Funcs>(__fs)...);
+}
+
 inline bool operator==(const loop_scheduler::executor_type& __a, const loop_scheduler::executor_type& __b) noexcept
 {
   return __a._M_scheduler == __b._M_scheduler;
@@ -0,0 +1,89 @@
+//
+// memory_resource_allocator.h
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Allocator that obtains memory from a memory resource.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_MEMORY_RESOURCE_ALLOCATOR_H
+#define EXECUTORS_EXPERIMENTAL_BITS_MEMORY_RESOURCE_ALLOCATOR_H
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+template <class _T, class _MemoryResource>
+inline memory_resource_allocator<_T, _MemoryResource>::memory_resource_allocator(
+  _MemoryResource* __r) noexcept
+    : _M_resource(__r)
+{
+}
+
+template <class _T, class _MemoryResource> template <class _U>
+inline memory_resource_allocator<_T, _MemoryResource>::memory_resource_allocator(
+  const memory_resource_allocator<_U, _MemoryResource>& __other) noexcept
+    : _M_resource(__other.resource())
+{
+}
+
+template <class _T, class _MemoryResource>
+inline _T* memory_resource_allocator<_T, _MemoryResource>::allocate(size_t __n)
+{
+  return static_cast<_T*>(_M_resource->allocate(sizeof(_T) * __n, alignof(_T)));
+}
+
+template <class _T, class _MemoryResource>
+inline void memory_resource_allocator<_T, _MemoryResource>::deallocate(_T* __p, size_t __n) noexcept
+{
+  _M_resource->deallocate(__p, sizeof(_T) * __n, alignof(_T));
+}
+
+template <class _T, class _MemoryResource>
+inline _MemoryResource* memory_resource_allocator<_T, _MemoryResource>::resource() const noexcept
+{
+  return _M_resource;
+}
+
+template <class _MemoryResource>
+inline memory_resource_allocator<void, _MemoryResource>::memory_resource_allocator(
+  _MemoryResource* __r) noexcept
+    : _M_resource(__r)
+{
+}
+
+template <class _MemoryResource> template <class _U>
+inline memory_resource_allocator<void, _MemoryResource>::memory_resource_allocator(
+  const memory_resource_allocator<_U, _MemoryResource>& __other) noexcept
+    : _M_resource(__other.resource())
+{
+}
+
+template <class _MemoryResource>
+inline _MemoryResource* memory_resource_allocator<void, _MemoryResource>::resource() const noexcept
+{
+  return _M_resource;
+}
+
+template <class _T, class _U, class _MemoryResource>
+inline bool operator==(const memory_resource_allocator<_T, _MemoryResource>& __a,
+  const memory_resource_allocator<_U, _MemoryResource>& __b) noexcept
+{
+  return __a.resource() == __b.resource();
+}
+
+template <class _T, class _U, class _MemoryResource>
+inline bool operator!=(const memory_resource_allocator<_T, _MemoryResource>& __a,
+  const memory_resource_allocator<_U, _MemoryResource>& __b) noexcept
+{
+  return __a.resource() != __b.resource();
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
@@ -0,0 +1,200 @@
+//
+// op_ring.h
+// ~~~~~~~~~
+// Per-thread ring of fixed-size slots for storing small operations.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_OP_RING_H
+#define EXECUTORS_EXPERIMENTAL_BITS_OP_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// Each thread owns a ring of slots from which it places the operations it
+// creates. Slots are taken in order by the owning thread only, but may be
+// given back by whichever thread completes the operation. When the next slot
+// is still occupied the caller is expected to fall back to the heap, so a
+// long-lived operation never blocks the ring.
+
+template <class _Purpose = void>
+class __op_ring
+{
+public:
+  static constexpr size_t _S_num_slots = 64;
+  static constexpr size_t _S_slot_size = 96;
+
+  // Whether an object of type _T may be placed in a slot.
+  template <class _T>
+  struct _Fits
+    : integral_constant<bool, sizeof(_T) <= _S_slot_size
+        && alignof(_T) <= alignof(max_align_t)>
+  {
+  };
+
+  __op_ring(const __op_ring&) = delete;
+  __op_ring& operator=(const __op_ring&) = delete;
+
+  // Take the next slot for the calling thread, or return null if it is in use.
+  static void* _Acquire() noexcept
+  {
+    __op_ring* __ring = _Instance();
+    if (!__ring)
+      return nullptr;
+
+    _Slot& __slot = __ring->_M_slots[__ring->_M_next];
+    __ring->_M_next = (__ring->_M_next + 1) % _S_num_slots;
+    if (__slot._M_in_use.load(memory_order_acquire))
+      return nullptr;
+
+    __slot._M_in_use.store(true, memory_order_relaxed);
+    return &__slot._M_storage;
+  }
+
+  // Give back a slot obtained from _Acquire. May be called on any thread.
+  static void _Release(void* __p) noexcept
+  {
+    static_cast<_Slot*>(__p)->_M_in_use.store(false, memory_order_release);
+  }
+
+private:
+  struct _Slot
+  {
+    typename aligned_storage<_S_slot_size, alignof(max_align_t)>::type _M_storage;
+    atomic<bool> _M_in_use;
+  };
+
+  static_assert(is_standard_layout<_Slot>::value,
+    "a slot's address must be the address of its storage");
+
+  __op_ring() : _M_next(0), _M_next_retired(nullptr)
+  {
+    for (size_t __i = 0; __i < _S_num_slots; ++__i)
+      _M_slots[__i]._M_in_use.store(false, memory_order_relaxed);
+  }
+
+  bool _Unused() const noexcept
+  {
+    for (size_t __i = 0; __i < _S_num_slots; ++__i)
+      if (_M_slots[__i]._M_in_use.load(memory_order_acquire))
+        return false;
+    return true;
+  }
+
+// The clang compiler shipped with Xcode doesn't support the thread_local
+// keyword, so there the ring is reached through a plain __thread pointer and
+// is never freed. Elsewhere the ring is freed when its thread exits. If
+// operations placed in it are still outstanding on other threads, it is
+// instead retired and adopted by the next thread to need a ring, so that a
+// pool whose threads come and go does not leak rings.
+#if defined(__APPLE__) && defined(__clang__) || defined(_MSC_VER)
+  static __op_ring* _Instance() noexcept
+  {
+    if (!_S_ring)
+      _S_ring = new (nothrow) __op_ring;
+    return _S_ring;
+  }
+#else
+  // Rings retired while still in use. Slots still in use are skipped by the
+  // adopting thread until they are released.
+  class _Retired_list
+  {
+  public:
+    _Retired_list() : _M_head(nullptr) {}
+
+    __op_ring* _Adopt() noexcept
+    {
+      {
+        lock_guard<mutex> __lock(_M_mutex);
+        if (__op_ring* __r = _M_head)
+        {
+          _M_head = __r->_M_next_retired;
+          __r->_M_next_retired = nullptr;
+          return __r;
+        }
+      }
+
+      return new (nothrow) __op_ring;
+    }
+
+    void _Retire(__op_ring* __r) noexcept
+    {
+      lock_guard<mutex> __lock(_M_mutex);
+      __r->_M_next_retired = _M_head;
+      _M_head = __r;
+    }
+
+  private:
+    mutex _M_mutex;
+    __op_ring* _M_head;
+  };
+
+  // The list is never destroyed, so that threads which outlive static
+  // destruction may still retire their rings to it.
+  static _Retired_list& _Retired()
+  {
+    static _Retired_list* __list = new _Retired_list;
+    return *__list;
+  }
+
+  struct _Owner
+  {
+    __op_ring* _M_ring;
+
+    ~_Owner()
+    {
+      if (_M_ring)
+      {
+        if (_M_ring->_Unused())
+          delete _M_ring;
+        else
+          _Retired()._Retire(_M_ring);
+        _M_ring = nullptr;
+      }
+    }
+  };
+
+  static __op_ring* _Instance() noexcept
+  {
+    static thread_local _Owner __owner;
+    if (!__owner._M_ring)
+      __owner._M_ring = _Retired()._Adopt();
+    return __owner._M_ring;
+  }
+#endif
+
+  _Slot _M_slots[_S_num_slots];
+  size_t _M_next;
+  __op_ring* _M_next_retired;
+
+#if defined(__APPLE__) && defined(__clang__)
+  static __thread __op_ring* _S_ring;
+#elif defined(_MSC_VER)
+  static __declspec(thread) __op_ring* _S_ring;
+#endif
+};
+
+#if defined(__APPLE__) && defined(__clang__)
+template <class _Purpose>
+__thread __op_ring<_Purpose>* __op_ring<_Purpose>::_S_ring;
+#elif defined(_MSC_VER)
+template <class _Purpose>
+__declspec(thread) __op_ring<_Purpose>* __op_ring<_Purpose>::_S_ring;
+#endif
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
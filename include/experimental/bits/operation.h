@@ -12,11 +12,16 @@
 #ifndef EXECUTORS_EXPERIMENTAL_BITS_OPERATION_H
 #define EXECUTORS_EXPERIMENTAL_BITS_OPERATION_H
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
 namespace std {
 namespace experimental {
 inline namespace concurrency_v1 {
 
 template <class _Operation> class __op_queue;
+template <class _Operation> class __op_mpsc_queue;
 
 class __operation
 {
@@ -24,6 +29,11 @@ public:
   virtual void _Destroy() = 0;
   virtual void _Complete() = 0;
 
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+  // The time at which the operation was submitted to a scheduler.
+  chrono::steady_clock::time_point _M_enqueue_time;
+#endif
+
 protected:
   __operation() : _M_next(0) {}
   virtual ~__operation() {}
@@ -31,6 +41,7 @@ protected:
 private:
   __operation* _M_next;
   template <class _Operation> friend class __op_queue;
+  template <class _Operation> friend class __op_mpsc_queue;
 };
 
 template <class _Operation>
@@ -96,6 +107,91 @@ private:
   _Operation* _M_front;
   _Operation* _M_back;
   template <class _OtherOperation> friend class __op_queue;
+  template <class _OtherOperation> friend class __op_mpsc_queue;
+};
+
+// A queue that any number of threads may push to without locking. Pushed
+// operations are held in a stack, and a single consumer at a time takes all of
+// them at once, restoring the order in which they were pushed.
+
+template <class _Operation>
+class __op_mpsc_queue
+{
+public:
+  __op_mpsc_queue() : _M_head(nullptr) {}
+  __op_mpsc_queue(const __op_mpsc_queue&) = delete;
+  __op_mpsc_queue& operator=(const __op_mpsc_queue&) = delete;
+
+  ~__op_mpsc_queue()
+  {
+    __op_queue<_Operation> __ops;
+    _Pop_all(__ops);
+  }
+
+  bool _Empty() const { return _M_head.load() == nullptr; }
+
+  void _Push(_Operation* __op)
+  {
+    _Link(__op, __op);
+  }
+
+  void _Push(__op_queue<_Operation>& __q)
+  {
+    // Reverse the operations so that they sit in the stack as if pushed one
+    // at a time.
+    _Operation* __first = __q._M_front;
+    if (!__first)
+      return;
+
+    _Operation* __last = nullptr;
+    for (_Operation* __op = __first; __op; )
+    {
+      _Operation* __next = static_cast<_Operation*>(__op->_M_next);
+      __op->_M_next = __last;
+      __last = __op;
+      __op = __next;
+    }
+
+    __q._M_front = __q._M_back = 0;
+    _Link(__last, __first);
+  }
+
+  // Move all pushed operations to the back of __q, returning the number moved.
+  size_t _Pop_all(__op_queue<_Operation>& __q)
+  {
+    _Operation* __op = _M_head.exchange(nullptr);
+    _Operation* __reversed = nullptr;
+    size_t __n = 0;
+    while (__op)
+    {
+      _Operation* __next = static_cast<_Operation*>(__op->_M_next);
+      __op->_M_next = __reversed;
+      __reversed = __op;
+      __op = __next;
+      ++__n;
+    }
+
+    while (__reversed)
+    {
+      _Operation* __next = static_cast<_Operation*>(__reversed->_M_next);
+      __q._Push(__reversed);
+      __reversed = __next;
+    }
+
+    return __n;
+  }
+
+private:
+  // Push the chain from __top down to __bottom, which are linked in stack order.
+  void _Link(_Operation* __top, _Operation* __bottom)
+  {
+    _Operation* __head = _M_head.load(memory_order_relaxed);
+    do
+      __bottom->_M_next = __head;
+    while (!_M_head.compare_exchange_weak(__head, __top));
+  }
+
+  atomic<_Operation*> _M_head;
 };
 
 } // inline namespace concurrency_v1
@@ -0,0 +1,163 @@
+//
+// priority_scheduler.h
+// ~~~~~~~~~~~~~~~~~~~~
+// Priority scheduler implementation.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_PRIORITY_SCHEDULER_H
+#define EXECUTORS_EXPERIMENTAL_BITS_PRIORITY_SCHEDULER_H
+
+#include <stdexcept>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+inline priority_scheduler::priority_scheduler(size_t __num_priorities,
+    size_t __starvation_limit)
+  : __priority_scheduler_base(__num_priorities, __starvation_limit)
+{
+}
+
+inline priority_scheduler::~priority_scheduler()
+{
+}
+
+inline priority_scheduler::executor_type priority_scheduler::get_executor(size_t __priority) const
+{
+  if (__priority >= _Num_priorities())
+    throw out_of_range("priority_scheduler::get_executor: invalid priority");
+  return executor_type(const_cast<priority_scheduler*>(this), __priority);
+}
+
+inline size_t priority_scheduler::num_priorities() const noexcept
+{
+  return _Num_priorities();
+}
+
+inline size_t priority_scheduler::run()
+{
+  return _Run();
+}
+
+template <class _Rep, class _Period>
+size_t priority_scheduler::run_for(
+  const chrono::duration<_Rep, _Period>& __rel_time)
+{
+  return this->run_until(chrono::steady_clock::now() + __rel_time);
+}
+
+template <class _Clock, class _Duration>
+size_t priority_scheduler::run_until(
+  const chrono::time_point<_Clock, _Duration>& __abs_time)
+{
+  return this->_Run_until(__abs_time, (numeric_limits<size_t>::max)());
+}
+
+inline size_t priority_scheduler::run_one()
+{
+  return _Run_one();
+}
+
+template <class _Rep, class _Period>
+size_t priority_scheduler::run_one_for(
+  const chrono::duration<_Rep, _Period>& __rel_time)
+{
+  return this->run_one_until(chrono::steady_clock::now() + __rel_time);
+}
+
+template <class _Clock, class _Duration>
+size_t priority_scheduler::run_one_until(
+  const chrono::time_point<_Clock, _Duration>& __abs_time)
+{
+  return this->_Run_until(__abs_time, 1);
+}
+
+inline size_t priority_scheduler::poll()
+{
+  return _Poll();
+}
+
+inline size_t priority_scheduler::poll_one()
+{
+  return _Poll(1);
+}
+
+inline void priority_scheduler::stop()
+{
+  _Stop();
+}
+
+inline bool priority_scheduler::stopped() const
+{
+  return _Stopped();
+}
+
+inline void priority_scheduler::restart()
+{
+  _Restart();
+}
+
+inline bool priority_scheduler::executor_type::running_in_this_thread() const noexcept
+{
+  return _M_scheduler->_Running_in_this_thread();
+}
+
+inline priority_scheduler& priority_scheduler::executor_type::context() noexcept
+{
+  return *_M_scheduler;
+}
+
+inline size_t priority_scheduler::executor_type::priority() const noexcept
+{
+  return _M_priority;
+}
+
+inline void priority_scheduler::executor_type::on_work_started() noexcept
+{
+  _M_scheduler->_Work_started();
+}
+
+inline void priority_scheduler::executor_type::on_work_finished() noexcept
+{
+  _M_scheduler->_Work_finished();
+}
+
+template <class _Func, class _Alloc>
+void priority_scheduler::executor_type::dispatch(_Func&& __f, const _Alloc& __a)
+{
+  _M_scheduler->_Dispatch(_M_priority, forward<_Func>(__f), __a);
+}
+
+template <class _Func, class _Alloc>
+void priority_scheduler::executor_type::post(_Func&& __f, const _Alloc& __a)
+{
+  _M_scheduler->_Post(_M_priority, forward<_Func>(__f), __a);
+}
+
+template <class _Func, class _Alloc>
+void priority_scheduler::executor_type::defer(_Func&& __f, const _Alloc& __a)
+{
+  _M_scheduler->_Post(_M_priority, forward<_Func>(__f), __a);
+}
+
+inline bool operator==(const priority_scheduler::executor_type& __a, const priority_scheduler::executor_type& __b) noexcept
+{
+  return __a._M_scheduler == __b._M_scheduler && __a._M_priority == __b._M_priority;
+}
+
+inline bool operator!=(const priority_scheduler::executor_type& __a, const priority_scheduler::executor_type& __b) noexcept
+{
+  return !(__a == __b);
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
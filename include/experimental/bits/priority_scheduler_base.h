@@ -0,0 +1,119 @@
+//
+// priority_scheduler_base.h
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// Thread-safe scheduler with a fixed number of priority lanes.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_PRIORITY_SCHEDULER_BASE_H
+#define EXECUTORS_EXPERIMENTAL_BITS_PRIORITY_SCHEDULER_BASE_H
+
+#include <cstddef>
+#include <memory>
+
+#include <experimental/bits/operation.h>
+#include <experimental/bits/queued_scheduler_base.h>
+#include <experimental/bits/scheduler.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// Operations are queued in one FIFO lane per priority, and the highest
+// priority non-empty lane is normally served first. To prevent starvation, a
+// lane that has been passed over a given number of times while non-empty is
+// served ahead of the lanes above it.
+
+class __priority_queue
+{
+public:
+  typedef size_t _Key;
+
+  template <class _Func, class _Alloc>
+  using _Op = __scheduler_op<_Func, _Alloc>;
+
+  __priority_queue(size_t __num_priorities, size_t __starvation_limit)
+    : _M_num_lanes(__num_priorities ? __num_priorities : 1),
+      _M_lanes(new _Lane[_M_num_lanes]),
+      _M_starvation_limit(__starvation_limit)
+  {
+  }
+
+  size_t _Num_priorities() const noexcept
+  {
+    return _M_num_lanes;
+  }
+
+  void _Push(size_t __priority, __operation* __op)
+  {
+    _M_lanes[__priority < _M_num_lanes ? __priority : _M_num_lanes - 1]._M_queue._Push(__op);
+  }
+
+  // Choose the lane to serve, passing over lower priority lanes unless one of
+  // them has waited too long.
+  __operation* _Pop(size_t& __priority)
+  {
+    _Lane* __highest = nullptr;
+    _Lane* __starved = nullptr;
+    for (size_t __i = _M_num_lanes; __i-- > 0; )
+    {
+      _Lane& __lane = _M_lanes[__i];
+      if (__lane._M_queue._Empty())
+        continue;
+
+      if (!__highest)
+        __highest = &__lane;
+      else if (_M_starvation_limit > 0 && __lane._M_skipped >= _M_starvation_limit)
+        __starved = __starved ? __starved : &__lane;
+      else
+        ++__lane._M_skipped;
+    }
+
+    _Lane& __lane = __starved ? *__starved : *__highest;
+    __lane._M_skipped = 0;
+    __priority = static_cast<size_t>(&__lane - _M_lanes.get());
+    __operation* __op = __lane._M_queue._Front();
+    __lane._M_queue._Pop();
+    return __op;
+  }
+
+  void _Completed(size_t)
+  {
+  }
+
+private:
+  struct _Lane
+  {
+    __op_queue<__operation> _M_queue;
+    size_t _M_skipped = 0;
+  };
+
+  const size_t _M_num_lanes;
+  unique_ptr<_Lane[]> _M_lanes;
+  const size_t _M_starvation_limit;
+};
+
+class __priority_scheduler_base
+  : public __queued_scheduler_base<__priority_queue>
+{
+public:
+  __priority_scheduler_base(size_t __num_priorities, size_t __starvation_limit)
+    : __queued_scheduler_base<__priority_queue>(__num_priorities, __starvation_limit)
+  {
+  }
+
+  size_t _Num_priorities() const noexcept
+  {
+    return _Queue_policy()._Num_priorities();
+  }
+};
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
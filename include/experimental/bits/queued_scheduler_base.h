@@ -0,0 +1,254 @@
+//
+// queued_scheduler_base.h
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Thread-safe scheduler whose queue ordering is supplied by a policy.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_QUEUED_SCHEDULER_BASE_H
+#define EXECUTORS_EXPERIMENTAL_BITS_QUEUED_SCHEDULER_BASE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include <experimental/bits/call_stack.h>
+#include <experimental/bits/operation.h>
+#include <experimental/bits/small_block_recycler.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// The run, poll, stop and work counting logic shared by schedulers that keep
+// all of their operations in a single mutex-protected queue. The order in
+// which operations are run is decided by the _Queue policy, which provides:
+//
+//   _Key                   The value that a post supplies to place an operation.
+//   _Op<_Func, _Alloc>     The operation type to allocate for a function object.
+//   _Push(__key, __op)     Add an operation. Called with the lock held.
+//   _Pop(__key)            Remove the next operation, storing its key. Called
+//                          with the lock held and only when an operation is
+//                          queued.
+//   _Completed(__key)      Called without the lock after an operation has run,
+//                          including when it exits by exception.
+
+template <class _Queue>
+class __queued_scheduler_base
+{
+public:
+  typedef __call_stack<__queued_scheduler_base> _Call_stack;
+  typedef typename _Queue::_Key _Key;
+
+  template <class... _Args>
+  explicit __queued_scheduler_base(_Args&&... __args)
+    : _M_queue(forward<_Args>(__args)...), _M_queued(0),
+      _M_outstanding_work(0), _M_stopped(false), _M_idle_threads(0)
+  {
+  }
+
+  bool _Running_in_this_thread() const noexcept
+  {
+    return _Call_stack::_Contains(const_cast<__queued_scheduler_base*>(this)) != nullptr;
+  }
+
+  template <class _F, class _A> void _Dispatch(const _Key& __key, _F&& __f, const _A& __a);
+  template <class _F, class _A> void _Post(const _Key& __key, _F&& __f, const _A& __a);
+
+  void _Work_started()
+  {
+    ++_M_outstanding_work;
+  }
+
+  void _Work_finished()
+  {
+    if (--_M_outstanding_work == 0)
+      _Stop();
+  }
+
+  void _Stop()
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    _M_stopped = true;
+    _M_condition.notify_all();
+  }
+
+  bool _Stopped() const
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    return _M_stopped;
+  }
+
+  void _Restart()
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    _M_stopped = false;
+  }
+
+  size_t _Run()
+  {
+    return _Run_until((chrono::steady_clock::time_point::max)(), (numeric_limits<size_t>::max)());
+  }
+
+  size_t _Run_one()
+  {
+    return _Run_until((chrono::steady_clock::time_point::max)(), 1);
+  }
+
+  template <class _Clock, class _Duration>
+  size_t _Run_until(const chrono::time_point<_Clock, _Duration>& __abs_time, size_t __limit)
+  {
+    if (_M_outstanding_work == 0)
+    {
+      _Stop();
+      return 0;
+    }
+
+    typename _Call_stack::__context __ctx(this);
+
+    const bool __forever = (__abs_time == (chrono::time_point<_Clock, _Duration>::max)());
+    size_t __n = 0;
+    unique_lock<mutex> __lock(_M_mutex);
+    while (__n < __limit)
+    {
+      if (!__forever && _Clock::now() >= __abs_time)
+        return __n;
+
+      while (_M_queued == 0 && !_M_stopped)
+      {
+        ++_M_idle_threads;
+        bool __timed_out = false;
+        if (__forever)
+          _M_condition.wait(__lock);
+        else
+          __timed_out = (_M_condition.wait_until(__lock, __abs_time) == cv_status::timeout);
+        --_M_idle_threads;
+        if (__timed_out)
+          return __n;
+      }
+
+      if (_M_stopped)
+        break;
+
+      _Complete_next(__lock);
+      ++__n;
+    }
+
+    return __n;
+  }
+
+  size_t _Poll(size_t __limit = (numeric_limits<size_t>::max)())
+  {
+    if (_M_outstanding_work == 0)
+    {
+      _Stop();
+      return 0;
+    }
+
+    typename _Call_stack::__context __ctx(this);
+
+    size_t __n = 0;
+    unique_lock<mutex> __lock(_M_mutex);
+    while (__n < __limit && _M_queued > 0 && !_M_stopped)
+    {
+      _Complete_next(__lock);
+      ++__n;
+    }
+
+    return __n;
+  }
+
+protected:
+  const _Queue& _Queue_policy() const noexcept
+  {
+    return _M_queue;
+  }
+
+private:
+  // Releases a completed operation's unit of work, even if it exits by
+  // exception.
+  struct _Work_release
+  {
+    __queued_scheduler_base* _M_scheduler;
+    _Key _M_key;
+
+    ~_Work_release()
+    {
+      _M_scheduler->_M_queue._Completed(_M_key);
+      _M_scheduler->_Work_finished();
+    }
+  };
+
+  // Remove the next operation and run it. Called with the lock held, which is
+  // released while the operation runs and then reacquired.
+  void _Complete_next(unique_lock<mutex>& __lock)
+  {
+    _Key __key;
+    __operation* __op = _M_queue._Pop(__key);
+    --_M_queued;
+    if (_M_queued > 0 && _M_idle_threads > 0)
+      _M_condition.notify_one();
+    __lock.unlock();
+
+    {
+      _Work_release __release{this, __key};
+      __op->_Complete();
+    }
+
+    __lock.lock();
+  }
+
+  mutable mutex _M_mutex;
+  condition_variable _M_condition;
+  _Queue _M_queue;
+  size_t _M_queued;
+  atomic<ptrdiff_t> _M_outstanding_work;
+  bool _M_stopped;
+  size_t _M_idle_threads;
+};
+
+template <class _Queue> template <class _F, class _A>
+void __queued_scheduler_base<_Queue>::_Dispatch(const _Key& __key, _F&& __f, const _A& __a)
+{
+  typedef typename decay<_F>::type _Func;
+  if (_Call_stack::_Contains(this))
+  {
+    _Func(forward<_F>(__f))();
+  }
+  else
+  {
+    this->_Post(__key, forward<_F>(__f), __a);
+  }
+}
+
+template <class _Queue> template <class _F, class _A>
+void __queued_scheduler_base<_Queue>::_Post(const _Key& __key, _F&& __f, const _A& __a)
+{
+  typedef typename decay<_F>::type _Func;
+  typedef typename _Queue::template _Op<_Func, _A> _Op;
+  auto __op(_Allocate_small_block<_Op>(__a, forward<_F>(__f), __a));
+
+  lock_guard<mutex> __lock(_M_mutex);
+  _M_queue._Push(__key, __op.get());
+  __op.release();
+
+  ++_M_outstanding_work;
+  ++_M_queued;
+  if (_M_idle_threads > 0)
+    _M_condition.notify_one();
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
@@ -16,6 +16,7 @@
 #include <mutex>
 #include <thread>
 #include <experimental/executor>
+#include <experimental/bits/reactor_host.h>
 #include <experimental/bits/timer_queue.h>
 
 namespace std {
@@ -23,18 +24,31 @@ namespace experimental {
 inline namespace concurrency_v1 {
 
 class __reactor
-  : public execution_context::service
+  : public execution_context::service,
+    public __reactor_timers
 {
 public:
   __reactor(execution_context& __c)
     : execution_context::service(__c),
+      _M_host(nullptr),
       _M_stopped(false)
   {
     _M_thread = std::thread([this](){ _Run(); });
   }
 
+  // Construct a reactor without a thread, whose timers are run by the host.
+  __reactor(execution_context& __c, __reactor_host& __host)
+    : execution_context::service(__c),
+      _M_host(&__host),
+      _M_stopped(false)
+  {
+  }
+
   ~__reactor()
   {
+    if (_M_host)
+      return;
+
     unique_lock<mutex> __lock(_M_mutex);
     _M_stopped = true;
     _M_condition.notify_one();
@@ -52,51 +66,84 @@ public:
     __lock.unlock();
   }
 
-  template <class _Clock, class _TimerTraits>
-  void _Add_timer_queue(__timer_queue<_Clock, _TimerTraits>& __q)
+  template <class _Queue>
+  void _Add_timer_queue(_Queue& __q)
   {
     unique_lock<mutex> __lock(_M_mutex);
     _M_queues._Insert(&__q);
   }
 
-  template <class _Clock, class _TimerTraits>
-  void _Remove_timer_queue(__timer_queue<_Clock, _TimerTraits>& __q)
+  template <class _Queue>
+  void _Remove_timer_queue(_Queue& __q)
   {
     unique_lock<mutex> __lock(_M_mutex);
     _M_queues._Erase(&__q);
   }
 
-  template <class _Clock, class _TimerTraits>
-  void _Move_timer(__timer_queue<_Clock, _TimerTraits>& __q,
-    typename __timer_queue<_Clock, _TimerTraits>::__per_timer_data& __empty_target,
-    typename __timer_queue<_Clock, _TimerTraits>::__per_timer_data& __source)
+  template <class _Queue>
+  void _Move_timer(_Queue& __q,
+    typename _Queue::__per_timer_data& __empty_target,
+    typename _Queue::__per_timer_data& __source)
   {
     unique_lock<mutex> __lock(_M_mutex);
     __q._Move_timer(__empty_target, __source);
   }
 
-  template <class _Clock, class _TimerTraits>
-  void _Enqueue_timer(__timer_queue<_Clock, _TimerTraits>& __q,
-    const typename _Clock::time_point& __expiry,
-    typename __timer_queue<_Clock, _TimerTraits>::__per_timer_data& __timer,
+  template <class _Queue>
+  void _Enqueue_timer(_Queue& __q,
+    const typename _Queue::_Time_point& __expiry,
+    typename _Queue::__per_timer_data& __timer,
     __wait_op_base* __op)
   {
     unique_lock<mutex> __lock(_M_mutex);
     if (__q._Enqueue_timer(__expiry, __timer, __op))
-      _M_condition.notify_one();
+      _Interrupt(__lock);
   }
 
-  template <class _Clock, class _TimerTraits>
-  void _Cancel_timer(__timer_queue<_Clock, _TimerTraits>& __q,
-      typename __timer_queue<_Clock, _TimerTraits>::__per_timer_data& __timer,
+  template <class _Queue>
+  void _Cancel_timer(_Queue& __q,
+      typename _Queue::__per_timer_data& __timer,
       size_t __max = ~size_t(0))
   {
     unique_lock<mutex> __lock(_M_mutex);
     if (__q._Cancel_timer(__timer, _M_ops, __max))
-      _M_condition.notify_one();
+      _Interrupt(__lock);
+  }
+
+  virtual chrono::steady_clock::duration _Get_ready_ops(
+    __op_queue<__operation>& __ops)
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    _M_queues._Get_ready_timers(_M_ops);
+    __ops._Push(_M_ops);
+
+    // As on the reactor's own thread, a far-off expiry is re-checked after at
+    // most a minute, so that the host never computes an overflowing deadline.
+    chrono::steady_clock::duration __d =
+      _M_queues._Wait_duration((chrono::steady_clock::duration::max)());
+    if (__d == (chrono::steady_clock::duration::max)())
+      return __d;
+    if (__d > chrono::seconds(60))
+      return chrono::seconds(60);
+    return __d > chrono::steady_clock::duration::zero()
+      ? __d : chrono::steady_clock::duration::zero();
   }
 
 private:
+  // Wake the thread that waits for the timers.
+  void _Interrupt(unique_lock<mutex>& __lock)
+  {
+    if (_M_host)
+    {
+      __lock.unlock();
+      _M_host->_Timers_changed();
+    }
+    else
+    {
+      _M_condition.notify_one();
+    }
+  }
+
   void _Run()
   {
     unique_lock<mutex> __lock(_M_mutex);
@@ -111,10 +158,16 @@ private:
         __op->_Complete();
       }
 
+      // The destructor's notification is lost if it arrives while the
+      // operations are being completed.
+      if (_M_stopped)
+        break;
+
       _M_condition.wait_for(__lock, _M_queues._Wait_duration(chrono::seconds(60)));
     }
   }
 
+  __reactor_host* _M_host;
   thread _M_thread;
   mutable mutex _M_mutex;
   condition_variable _M_condition;
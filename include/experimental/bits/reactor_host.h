@@ -0,0 +1,55 @@
+//
+// reactor_host.h
+// ~~~~~~~~~~~~~~
+// Interfaces between the reactor and an execution context that runs timers.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_REACTOR_HOST_H
+#define EXECUTORS_EXPERIMENTAL_BITS_REACTOR_HOST_H
+
+#include <chrono>
+#include <experimental/bits/operation.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// A reactor normally runs its timers on a thread of its own. It may instead be
+// hosted by an execution context whose threads wait for the timers' expiry as
+// part of waiting for work, and complete the timers' operations themselves.
+
+class __reactor_host
+{
+public:
+  // Called by the reactor, without its lock held, when a timer is added ahead
+  // of all others or has operations cancelled, so that a waiting thread must
+  // recalculate its deadline.
+  virtual void _Timers_changed() = 0;
+
+protected:
+  ~__reactor_host() {}
+};
+
+class __reactor_timers
+{
+public:
+  // Take the operations of expired and cancelled timers, and return how long
+  // the caller may wait before calling again, or the maximum duration if no
+  // timer is due to expire.
+  virtual chrono::steady_clock::duration _Get_ready_ops(
+    __op_queue<__operation>& __ops) = 0;
+
+protected:
+  ~__reactor_timers() {}
+};
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
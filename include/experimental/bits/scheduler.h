@@ -14,76 +14,237 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <type_traits>
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# include <intrin.h>
+#endif
+
 #include <experimental/bits/call_stack.h>
+#include <experimental/bits/cpu_topology.h>
+#include <experimental/bits/op_ring.h>
 #include <experimental/bits/operation.h>
+#include <experimental/bits/reactor_host.h>
+#include <experimental/bits/scheduler_options.h>
+#include <experimental/bits/scheduler_statistics.h>
 #include <experimental/bits/small_block_recycler.h>
+#include <experimental/bits/worker_affinity.h>
 
 namespace std {
 namespace experimental {
 inline namespace concurrency_v1 {
 
 class __scheduler
+  : public __reactor_host
 {
+  // Local run queue owned by a single thread when work stealing is enabled.
+  struct _Worker
+  {
+    mutex _M_mutex;
+    __op_queue<__operation> _M_queue;
+    atomic<size_t> _M_size{0};
+    atomic<bool> _M_claimed{false};
+    atomic<size_t> _M_node{0};
+    size_t _M_index = 0;
+  };
+
 public:
   struct _Context
   {
     __scheduler* _M_scheduler;
     __op_queue<__operation> _M_private_queue;
+    __op_queue<__operation> _M_batch_queue;
     __call_stack<__scheduler, _Context>::__context _M_context;
     unique_lock<mutex> _M_lock;
     ptrdiff_t _M_work_delta;
-
-    explicit _Context(__scheduler* __s)
-      : _M_scheduler(__s), _M_context(__s, *this), _M_lock(__s->_M_mutex),
-        _M_work_delta(0)
+    _Worker* _M_worker;
+    size_t _M_batch_limit;
+    atomic<__operation*> _M_next_op;
+    size_t _M_next_runs;
+    _Context* _M_next_slot_owner;
+    __worker_id _M_saved_worker;
+
+    explicit _Context(__scheduler* __s, size_t __batch_limit = 1)
+      : _M_scheduler(__s), _M_context(__s, *this), _M_lock(__s->_M_mutex, defer_lock),
+        _M_work_delta(0), _M_worker(__s->_Claim_worker()), _M_batch_limit(__batch_limit),
+        _M_next_op(nullptr), _M_next_runs(0), _M_next_slot_owner(nullptr),
+        _M_saved_worker(__this_worker())
     {
+      if (_M_worker)
+        __this_worker() = { _M_scheduler, _M_worker->_M_index, &_M_scheduler->_M_migrations };
+
+      if (!_M_scheduler->_M_workers && !_M_scheduler->_M_single_threaded)
+        _M_scheduler->_Acquire(_M_lock);
+
+      // Threads that hold an operation in their slot are listed so that idle
+      // peers can find it.
+      if (_M_scheduler->_M_next_slot_budget > 0)
+      {
+        if (_M_lock.owns_lock())
+          _M_scheduler->_Add_next_slot_owner(*this);
+        else
+        {
+          _Lock_guard __lock(_M_scheduler);
+          _M_scheduler->_Add_next_slot_owner(*this);
+        }
+      }
     }
 
     ~_Context()
     {
-      if (_M_work_delta)
-        if (_M_scheduler->_M_outstanding_work.fetch_add(_M_work_delta) == -_M_work_delta)
-          _M_scheduler->_Stop();
+      if (_M_scheduler->_M_next_slot_budget > 0)
+      {
+        if (_M_lock.owns_lock())
+          _M_scheduler->_Remove_next_slot_owner(*this);
+        else
+        {
+          _Lock_guard __lock(_M_scheduler);
+          _M_scheduler->_Remove_next_slot_owner(*this);
+        }
+
+        if (__operation* __op = _M_next_op.exchange(nullptr))
+          _M_private_queue._Push(__op);
+      }
 
-      if (!_M_private_queue._Empty())
+      _Flush_work();
+
+      if (_M_worker)
+      {
+        {
+          lock_guard<mutex> __lock(_M_worker->_M_mutex);
+          _M_private_queue._Push(_M_worker->_M_queue);
+          _M_worker->_M_size = 0;
+        }
+
+        _M_worker->_M_claimed = false;
+        __this_worker() = _M_saved_worker;
+      }
+
+      if (!_M_private_queue._Empty() || !_M_batch_queue._Empty())
       {
-        if (!_M_lock.owns_lock())
-          _M_lock.lock();
+        if (!_M_lock.owns_lock() && !_M_scheduler->_M_single_threaded)
+          _M_scheduler->_Acquire(_M_lock);
+
+        // Batched operations were dequeued ahead of everything still in the
+        // shared queue, so they go back at the front.
+        __op_queue<__operation> __ops;
+        size_t __n = _Splice(__ops, _M_batch_queue);
+        __ops._Push(_M_scheduler->_M_queue);
+        _M_scheduler->_M_queue._Push(__ops);
+        __n += _Splice(_M_scheduler->_M_queue, _M_private_queue);
+        _M_scheduler->_M_queue_size += __n;
+        _M_scheduler->_M_condition.notify_all();
+      }
+    }
 
-        _M_scheduler->_M_queue._Push(_M_private_queue);
+    // Apply this thread's accumulated changes to the shared work count. A
+    // thread must do this before it waits for work, so that the count is able
+    // to reach zero.
+    void _Flush_work()
+    {
+      if (ptrdiff_t __delta = _M_work_delta)
+      {
+        _M_work_delta = 0;
+        if (_M_scheduler->_M_outstanding_work.fetch_add(__delta) == -__delta)
+        {
+          if (_M_lock.owns_lock())
+            _M_scheduler->_Stop_locked();
+          else
+            _M_scheduler->_Stop();
+        }
       }
     }
 
     void _Lock()
     {
-      if (_M_work_delta)
+      // A single-threaded scheduler runs straight from the private queue.
+      if (_M_scheduler->_M_single_threaded)
+        return;
+
+      // Once the next-operation slot has used up its budget, its occupant goes
+      // to the back of the queue like any other posted operation.
+      if (_M_next_op.load(memory_order_relaxed) == nullptr)
+        _M_next_runs = 0;
+      else if (_M_next_runs >= _M_scheduler->_M_next_slot_budget)
       {
-        if (_M_scheduler->_M_outstanding_work.fetch_add(_M_work_delta) == -_M_work_delta)
-          _M_scheduler->_Stop();
-        _M_work_delta = 0;
+        if (__operation* __op = _M_next_op.exchange(nullptr))
+          _M_private_queue._Push(__op);
+        _M_next_runs = 0;
+      }
+
+      // Work released by completed operations is kept for reuse, but work
+      // added for deferred operations must be counted before they are made
+      // visible to other threads.
+      if (_M_work_delta > 0)
+        _Flush_work();
+
+      if (_M_scheduler->_M_workers)
+      {
+        // Threads running a work-stealing scheduler only take the shared
+        // lock when their local queue runs dry.
+        if (!_M_private_queue._Empty())
+        {
+          if (_M_worker)
+            _M_scheduler->_Push_local(*_M_worker, _M_private_queue);
+          else
+            _M_scheduler->_Push_shared(_M_private_queue);
+        }
+        return;
       }
 
+      // Operations already taken in a batch, or waiting in the slot, are run
+      // without the lock.
+      if (_M_private_queue._Empty()
+          && (!_M_batch_queue._Empty() || _M_next_op.load(memory_order_relaxed)))
+        return;
+
       if (!_M_lock.owns_lock())
-        _M_lock.lock();
+        _M_scheduler->_Acquire(_M_lock);
 
       if (!_M_private_queue._Empty())
-        _M_scheduler->_M_queue._Push(_M_private_queue);
+        _M_scheduler->_M_queue_size += _Splice(_M_scheduler->_M_queue, _M_private_queue);
     }
   };
 
   typedef __call_stack<__scheduler, _Context> _Call_stack;
 
-  __scheduler(size_t __concurrency_hint = ~size_t(0))
-    : _M_outstanding_work(0), _M_stopped(false),
-      _M_one_thread(__concurrency_hint == 1)
+  __scheduler(size_t __concurrency_hint = ~size_t(0),
+    const scheduler_options& __options = scheduler_options())
+    : _M_queue_size(0), _M_outstanding_work(0), _M_stopped(false),
+      _M_one_thread(__concurrency_hint == 1),
+      _M_single_threaded(_M_one_thread && __options.single_threaded),
+      _M_next_slot_budget(_M_single_threaded ? 0 : __options.next_slot_budget),
+      _M_batch_size(__options.batch_size ? __options.batch_size : 1),
+      _M_spin_count(__options.spin_count), _M_yield_count(__options.yield_count),
+      _M_num_workers(0), _M_idle_workers(0), _M_next_slot_owners(nullptr),
+      _M_numa_local(__options.numa_local_queues && __options.work_stealing
+        && !_M_one_thread && __cpu_topology::_Instance()._Num_nodes() > 1),
+      _M_next_submit(0), _M_track_progress(__options.max_threads > 0),
+      _M_last_progress(0),
+      _M_strand_affinity(__options.strand_affinity && __options.work_stealing && !_M_one_thread),
+      _M_migrations(0), _M_timers(nullptr), _M_timer_check(0)
   {
+    if (__options.work_stealing && !_M_one_thread)
+    {
+      _M_num_workers = __concurrency_hint;
+      if (_M_num_workers == ~size_t(0))
+        _M_num_workers = thread::hardware_concurrency();
+      if (_M_num_workers == 0)
+        _M_num_workers = 1;
+      _M_workers.reset(new _Worker[_M_num_workers]);
+      for (size_t __i = 0; __i < _M_num_workers; ++__i)
+        _M_workers[__i]._M_index = __i;
+    }
+
+    if (_M_track_progress)
+      _Record_progress();
   }
 
   bool _Running_in_this_thread() const noexcept
@@ -91,27 +252,46 @@ public:
     return _Call_stack::_Contains(const_cast<__scheduler*>(this)) != nullptr;
   }
 
+  // Run the given timers from the threads that run the scheduler. Must be
+  // called before any thread runs the scheduler.
+  void _Set_timers(__reactor_timers& __timers)
+  {
+    _M_timers = &__timers;
+  }
+
+  virtual void _Timers_changed()
+  {
+    _Lock_guard __lock(this);
+    _M_timer_check.store(0, memory_order_relaxed);
+    _M_condition.notify_one();
+  }
+
   template <class _F, class _A> void _Dispatch(_F&& __f, const _A& __a);
   template <class _F, class _A> void _Post(_F&& __f, const _A& __a);
   template <class _F, class _A> void _Defer(_F&& __f, const _A& __a);
+  template <class _Iter, class _A> void _Post_range(_Iter __first, _Iter __last, const _A& __a);
+  template <class _A, class... _F> void _Post_each(const _A& __a, _F&&... __f);
 
   void _Work_started()
   {
-    ++_M_outstanding_work;
+    if (_Context* __ctx = _Call_stack::_Contains(this))
+      _Add_work(*__ctx, 1);
+    else
+      ++_M_outstanding_work;
   }
 
   void _Work_finished()
   {
-    if (--_M_outstanding_work == 0)
+    if (_Context* __ctx = _Call_stack::_Contains(this))
+      --__ctx->_M_work_delta;
+    else if (--_M_outstanding_work == 0)
       _Stop();
   }
 
   void _Stop()
   {
     lock_guard<mutex> __lock(_M_mutex);
-
-    _M_stopped = true;
-    _M_condition.notify_all();
+    _Stop_locked();
   }
 
   bool _Stopped() const
@@ -134,7 +314,7 @@ public:
       return 0;
     }
 
-    _Context __ctx(this);
+    _Context __ctx(this, _M_batch_size);
 
     std::size_t __n = 0;
     for (; _Do_run_one(__ctx); __ctx._Lock())
@@ -177,7 +357,7 @@ public:
       return 0;
     }
 
-    _Context __ctx(this);
+    _Context __ctx(this, _M_batch_size);
 
     std::size_t __n = 0;
     for (; _Do_run_one_until(__ctx, __abs_time); __ctx._Lock())
@@ -208,7 +388,7 @@ public:
       return 0;
     }
 
-    _Context __ctx(this);
+    _Context __ctx(this, _M_batch_size);
 
     std::size_t __n = 0;
     for (; _Do_poll_one(__ctx); __ctx._Lock())
@@ -217,6 +397,57 @@ public:
     return __n;
   }
 
+  // Run until stopped, or until no operation becomes ready for the given
+  // period. The caller determines which by checking _Stopped().
+  template <class _Rep, class _Period>
+  size_t _Run_while_busy(const chrono::duration<_Rep, _Period>& __idle_timeout)
+  {
+    if (_M_outstanding_work == 0)
+    {
+      _Stop();
+      return 0;
+    }
+
+    _Context __ctx(this, _M_batch_size);
+
+    std::size_t __n = 0;
+    for (; _Do_run_one_until(__ctx, chrono::steady_clock::now() + __idle_timeout); __ctx._Lock())
+      if (__n != (numeric_limits<size_t>::max)())
+        ++__n;
+    return __n;
+  }
+
+  // Whether submitted work is held up because no thread is free to run it.
+  // Called without the lock, so the answer is only a hint.
+  bool _Backlogged(size_t __depth, chrono::steady_clock::duration __latency) const
+  {
+    if (_M_idle_workers.load(memory_order_relaxed) > 0 || _M_stopped.load(memory_order_relaxed))
+      return false;
+
+    size_t __size = _M_queue_size.load(memory_order_relaxed);
+    if (__size == 0)
+      return false;
+    if (__size >= __depth)
+      return true;
+
+    chrono::steady_clock::duration __since_progress = chrono::steady_clock::now().time_since_epoch()
+      - chrono::steady_clock::duration(_M_last_progress.load(memory_order_relaxed));
+    return __since_progress >= __latency;
+  }
+
+  scheduler_statistics _Statistics() const
+  {
+    scheduler_statistics __stats;
+    __stats.queue_depth = _M_queue_size.load(memory_order_relaxed);
+    for (size_t __i = 0; __i < _M_num_workers; ++__i)
+      __stats.queue_depth += _M_workers[__i]._M_size.load(memory_order_relaxed);
+    __stats.strand_migrations = _M_migrations.load(memory_order_relaxed);
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+    _M_statistics._Read(__stats);
+#endif
+    return __stats;
+  }
+
   size_t _Poll_one()
   {
     if (_M_outstanding_work == 0)
@@ -231,25 +462,146 @@ public:
   }
 
 private:
+  // Must be called with the lock held.
+  void _Stop_locked()
+  {
+    _M_stopped = true;
+    _M_condition.notify_all();
+  }
+
+  // Account for work submitted by a thread running the scheduler. Units of work
+  // released by operations the thread has completed, but not yet returned to
+  // the shared count, are reused first, so in the common case of a handler that
+  // submits a follow-up operation the shared count is not touched at all.
+  void _Add_work(_Context& __ctx, size_t __n)
+  {
+    ptrdiff_t __needed = static_cast<ptrdiff_t>(__n);
+    if (__ctx._M_work_delta < 0)
+    {
+      ptrdiff_t __reused = -__ctx._M_work_delta < __needed ? -__ctx._M_work_delta : __needed;
+      __ctx._M_work_delta += __reused;
+      __needed -= __reused;
+    }
+    if (__needed > 0)
+      _M_outstanding_work += __needed;
+  }
+
+  // Acquire the scheduler lock, recording the time spent waiting for it.
+  void _Acquire(unique_lock<mutex>& __lock)
+  {
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+    if (!__lock.try_lock())
+    {
+      chrono::steady_clock::time_point __start = chrono::steady_clock::now();
+      __lock.lock();
+      _M_statistics._Record_lock_wait(chrono::steady_clock::now() - __start);
+    }
+#else
+    __lock.lock();
+#endif
+  }
+
+  class _Lock_guard
+  {
+  public:
+    explicit _Lock_guard(__scheduler* __s)
+      : _M_lock(__s->_M_mutex, defer_lock)
+    {
+      __s->_Acquire(_M_lock);
+    }
+
+    _Lock_guard(const _Lock_guard&) = delete;
+    _Lock_guard& operator=(const _Lock_guard&) = delete;
+
+  private:
+    unique_lock<mutex> _M_lock;
+  };
+
+  // Note the time at which an operation is submitted.
+  static void _Stamp(__operation* __op)
+  {
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+    __op->_M_enqueue_time = chrono::steady_clock::now();
+#else
+    (void)__op;
+#endif
+  }
+
+  struct _Op_destroy
+  {
+    void operator()(__operation* __op) const { __op->_Destroy(); }
+  };
+
+  typedef unique_ptr<__operation, _Op_destroy> _Op_ptr;
+
+  // Create the operation for a posted function. Small functions that use the
+  // default allocator are placed in the calling thread's ring of operation
+  // slots, and all others are allocated.
+  template <class _Func, class _F, class _A>
+  static _Op_ptr _Make_op(_F&& __f, const _A& __a);
+
+  template <class _Func, class _F, class _A>
+  static _Op_ptr _Make_op(_F&& __f, const _A& __a, true_type);
+
+  template <class _Func, class _F, class _A>
+  static _Op_ptr _Make_op(_F&& __f, const _A& __a, false_type);
+
   size_t _Do_run_one(_Context& __ctx)
   {
-    while (_M_queue._Empty() && !_M_stopped)
-      _M_condition.wait(__ctx._M_lock);
+    if (_M_single_threaded)
+      return _Do_run_one_single(__ctx, (chrono::steady_clock::time_point::max)());
 
-    if (_M_stopped)
-      return 0;
+    _Poll_timers(__ctx);
 
-    __operation* __op = _M_queue._Front();
-    _M_queue._Pop();
+    if (__operation* __op = _Take_next_op(__ctx))
+      return _Complete_next_op(__ctx, __op);
 
-    if (!_M_one_thread && !_M_queue._Empty())
-      _M_condition.notify_one();
+    if (!__ctx._M_batch_queue._Empty())
+      return _Complete_batched_op(__ctx);
 
-    __ctx._M_lock.unlock();
-    __ctx._M_work_delta = -1;
+    if (_M_workers)
+    {
+      __operation* __op;
+      while ((__op = _Next_stealing_op(__ctx)) == nullptr)
+      {
+        __ctx._Flush_work();
+        if (!(_Spins() && _Spin_for_work()))
+          if (!_Park(__ctx, chrono::steady_clock::time_point::max()))
+            return 0;
+      }
+      return _Complete_op(__ctx, __op);
+    }
 
-    __op->_Complete();
-    return 1;
+    // The lock is not taken while the slot is occupied, and an idle peer may
+    // have since moved the occupant away.
+    if (!__ctx._M_lock.owns_lock())
+      _Acquire(__ctx._M_lock);
+
+    _Drain_injected();
+    if (_M_queue._Empty())
+      __ctx._Flush_work();
+
+    if (_M_queue._Empty() && !_M_stopped && _Spins())
+    {
+      __ctx._M_lock.unlock();
+      _Spin_for_work();
+      _Acquire(__ctx._M_lock);
+      _Drain_injected();
+    }
+
+    while (_M_queue._Empty() && !_M_stopped)
+    {
+      ++_M_idle_workers;
+      if (_M_injected._Empty() && !_Publish_next_ops(__ctx))
+        _Wait(__ctx, (chrono::steady_clock::time_point::max)());
+      --_M_idle_workers;
+      _Drain_injected();
+    }
+
+    if (_M_stopped)
+      return 0;
+
+    return _Complete_op(__ctx, _Dequeue(__ctx));
   }
 
   template <class _Clock, class _Duration>
@@ -259,50 +611,785 @@ private:
     if (_Clock::now() >= __abs_time)
       return 0;
 
+    if (_M_single_threaded)
+      return _Do_run_one_single(__ctx, __abs_time);
+
+    _Poll_timers(__ctx);
+
+    if (__operation* __op = _Take_next_op(__ctx))
+      return _Complete_next_op(__ctx, __op);
+
+    if (!__ctx._M_batch_queue._Empty())
+      return _Complete_batched_op(__ctx);
+
+    if (_M_workers)
+    {
+      __operation* __op;
+      while ((__op = _Next_stealing_op(__ctx)) == nullptr)
+      {
+        __ctx._Flush_work();
+        if (!(_Spins() && _Spin_for_work()))
+          if (!_Park(__ctx, __abs_time))
+            return 0;
+      }
+      return _Complete_op(__ctx, __op);
+    }
+
+    // The lock is not taken while the slot is occupied, and an idle peer may
+    // have since moved the occupant away.
+    if (!__ctx._M_lock.owns_lock())
+      _Acquire(__ctx._M_lock);
+
+    _Drain_injected();
+    if (_M_queue._Empty())
+      __ctx._Flush_work();
+
+    if (_M_queue._Empty() && !_M_stopped && _Spins())
+    {
+      __ctx._M_lock.unlock();
+      _Spin_for_work();
+      _Acquire(__ctx._M_lock);
+      _Drain_injected();
+    }
+
     while (_M_queue._Empty() && !_M_stopped)
-      if (_M_condition.wait_until(__ctx._M_lock, __abs_time) == cv_status::timeout)
+    {
+      ++_M_idle_workers;
+      cv_status __status = cv_status::no_timeout;
+      if (_M_injected._Empty() && !_Publish_next_ops(__ctx))
+        __status = _Wait(__ctx, __abs_time);
+      --_M_idle_workers;
+      _Drain_injected();
+      if (__status == cv_status::timeout && _M_queue._Empty())
         return 0;
+    }
 
     if (_M_stopped)
       return 0;
 
+    return _Complete_op(__ctx, _Dequeue(__ctx));
+  }
+
+  size_t _Do_poll_one(_Context& __ctx)
+  {
+    if (_M_single_threaded)
+      return _Do_run_one_single(__ctx, chrono::steady_clock::now());
+
+    _Poll_timers(__ctx);
+
+    if (__operation* __op = _Take_next_op(__ctx))
+      return _Complete_next_op(__ctx, __op);
+
+    if (!__ctx._M_batch_queue._Empty())
+      return _Complete_batched_op(__ctx);
+
+    if (_M_workers)
+    {
+      __operation* __op = _Next_stealing_op(__ctx);
+      return __op ? _Complete_op(__ctx, __op) : 0;
+    }
+
+    if (!__ctx._M_lock.owns_lock())
+      _Acquire(__ctx._M_lock);
+
+    _Drain_injected();
+    if (_M_queue._Empty() || _M_stopped)
+      return 0;
+
+    return _Complete_op(__ctx, _Dequeue(__ctx));
+  }
+
+  // Run the next operation of a scheduler that is used by one thread. Work
+  // posted from within the scheduler is run from the private queue, without
+  // the lock and without touching any shared state. There is no thread that
+  // might submit more work, so an empty queue means there is nothing to wait
+  // for, other than the scheduler's own timers.
+  template <class _Clock, class _Duration>
+  size_t _Do_run_one_single(_Context& __ctx,
+    const chrono::time_point<_Clock, _Duration>& __abs_time)
+  {
+    _Poll_timers(__ctx);
+
+    if (!_M_queue._Empty())
+    {
+      __ctx._M_private_queue._Push(_M_queue);
+      _M_queue_size = 0;
+    }
+    if (!_M_injected._Empty())
+      _M_injected._Pop_all(__ctx._M_private_queue);
+
+    if (_M_stopped.load(memory_order_relaxed))
+      return 0;
+
+    __operation* __op = __ctx._M_private_queue._Front();
+    if (__op == nullptr)
+    {
+      __ctx._Flush_work();
+      if (_M_timers && _Wait_for_timers(__ctx, __abs_time))
+        return _Do_run_one_single(__ctx, __abs_time);
+      return 0;
+    }
+
+    __ctx._M_private_queue._Pop();
+    return _Complete_op(__ctx, __op);
+  }
+
+  // Number of additional operations a thread may take along with the one it is
+  // about to run, given the number left in the shared queue. Leaving at least
+  // half of the queue behind means other threads are still woken to help.
+  size_t _Batch_extra(const _Context& __ctx, size_t __remaining) const
+  {
+    size_t __limit = _M_one_thread ? __remaining : __remaining / 2;
+    size_t __extra = __ctx._M_batch_limit - 1;
+    return __extra < __limit ? __extra : __limit;
+  }
+
+  // Remove the next operation from the shared queue, moving up to a batch of
+  // the operations that follow it into the thread's batch queue. Must be
+  // called with the lock held, and releases it.
+  __operation* _Dequeue(_Context& __ctx)
+  {
     __operation* __op = _M_queue._Front();
     _M_queue._Pop();
+    --_M_queue_size;
+    _Record_progress();
 
-    if (!_M_one_thread && !_M_queue._Empty())
+    for (size_t __extra = _Batch_extra(__ctx, _M_queue_size); __extra > 0; --__extra)
+    {
+      __operation* __next = _M_queue._Front();
+      _M_queue._Pop();
+      __ctx._M_batch_queue._Push(__next);
+      --_M_queue_size;
+    }
+
+    if (!_M_one_thread && !_M_queue._Empty() && _M_idle_workers > 0)
       _M_condition.notify_one();
 
     __ctx._M_lock.unlock();
-    __ctx._M_work_delta = -1;
+    return __op;
+  }
+
+  // Move operations submitted from outside a single-threaded scheduler to the
+  // shared queue. Must be called with the lock held, which makes the lock
+  // holder the injection queue's only consumer.
+  void _Drain_injected()
+  {
+    if (!_M_injected._Empty())
+      _M_queue_size += _M_injected._Pop_all(_M_queue);
+  }
+
+  // Submit operations from outside a single-threaded scheduler without taking
+  // the lock. The lock is needed only to wake the scheduler's thread, and only
+  // if it is waiting.
+  void _Inject(__operation* __op)
+  {
+    _M_injected._Push(__op);
+    _Wake_idle_worker();
+  }
+
+  void _Inject(__op_queue<__operation>& __ops)
+  {
+    _M_injected._Push(__ops);
+    _Wake_idle_worker();
+  }
+
+  // Note the time an operation was taken from the shared queue, for use by
+  // _Backlogged().
+  void _Record_progress()
+  {
+    if (_M_track_progress)
+      _M_last_progress.store(chrono::steady_clock::now().time_since_epoch().count(),
+        memory_order_relaxed);
+  }
+
+  // Take the operation from the thread's slot, unless an idle peer has moved
+  // it to the shared queue first.
+  static __operation* _Take_next_op(_Context& __ctx)
+  {
+    if (__ctx._M_next_op.load(memory_order_relaxed) == nullptr)
+      return nullptr;
+    return __ctx._M_next_op.exchange(nullptr);
+  }
+
+  size_t _Complete_next_op(_Context& __ctx, __operation* __op)
+  {
+    if (__ctx._M_lock.owns_lock())
+      __ctx._M_lock.unlock();
+
+    if (_M_stopped.load(memory_order_relaxed))
+    {
+      // Keep the operation for when the scheduler is restarted.
+      __ctx._M_next_op.store(__op);
+      return 0;
+    }
 
+    ++__ctx._M_next_runs;
+    return _Complete_op(__ctx, __op);
+  }
+
+  size_t _Complete_batched_op(_Context& __ctx)
+  {
+    if (__ctx._M_lock.owns_lock())
+      __ctx._M_lock.unlock();
+
+    if (_M_stopped.load(memory_order_relaxed))
+      return 0;
+
+    __operation* __op = __ctx._M_batch_queue._Front();
+    __ctx._M_batch_queue._Pop();
+    return _Complete_op(__ctx, __op);
+  }
+
+  // Releases a completed operation's unit of work, even if it exits by
+  // exception. The unit stays with the thread until _Flush_work is called.
+  struct _Work_release
+  {
+    _Context& _M_ctx;
+    ~_Work_release() { --_M_ctx._M_work_delta; }
+  };
+
+  size_t _Complete_op(_Context& __ctx, __operation* __op)
+  {
+    _Work_release __release{__ctx};
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+    chrono::steady_clock::time_point __start = chrono::steady_clock::now();
+    _M_statistics._Record_start(__start - __op->_M_enqueue_time);
     __op->_Complete();
+    _M_statistics._Record_execution(chrono::steady_clock::now() - __start);
+#else
+    __op->_Complete();
+#endif
     return 1;
   }
 
-  size_t _Do_poll_one(_Context& __ctx)
+  static size_t _Splice(__op_queue<__operation>& __to, __op_queue<__operation>& __from)
   {
-    if (_M_queue._Empty() || _M_stopped)
-      return 0;
+    size_t __n = 0;
+    while (__operation* __op = __from._Front())
+    {
+      __from._Pop();
+      __to._Push(__op);
+      ++__n;
+    }
+    return __n;
+  }
 
-    __operation* __op = _M_queue._Front();
-    _M_queue._Pop();
+  _Worker* _Claim_worker()
+  {
+    for (size_t __i = 0; __i < _M_num_workers; ++__i)
+    {
+      bool __expected = false;
+      if (_M_workers[__i]._M_claimed.compare_exchange_strong(__expected, true))
+      {
+        if (_M_numa_local)
+          _M_workers[__i]._M_node.store(
+            __cpu_topology::_Instance()._Current_node(), memory_order_relaxed);
+        return &_M_workers[__i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Choose a thread running on the calling thread's NUMA node to receive a
+  // submission from outside the scheduler. Threads are chosen round-robin so
+  // that a node's submissions are spread across its threads.
+  _Worker* _Node_worker()
+  {
+    if (!_M_numa_local)
+      return nullptr;
 
-    if (!_M_one_thread && !_M_queue._Empty())
+    size_t __node = __cpu_topology::_Instance()._Current_node();
+    size_t __start = _M_next_submit.fetch_add(1, memory_order_relaxed);
+    for (size_t __i = 0; __i < _M_num_workers; ++__i)
+    {
+      _Worker& __w = _M_workers[(__start + __i) % _M_num_workers];
+      if (__w._M_claimed.load(memory_order_relaxed)
+          && __w._M_node.load(memory_order_relaxed) == __node)
+        return &__w;
+    }
+    return nullptr;
+  }
+
+  // Find the thread that last ran a function object's sequence, if it is not
+  // the calling thread and is still running the scheduler.
+  _Worker* _Affine_worker(const __worker_affinity* __a, _Context* __ctx)
+  {
+    size_t __index;
+    if (__a && __a->_Last_worker(this, __index) && __index < _M_num_workers)
+    {
+      _Worker& __w = _M_workers[__index];
+      if (__ctx && __ctx->_M_worker == &__w)
+        return nullptr;
+      if (__w._M_claimed.load(memory_order_relaxed))
+        return &__w;
+    }
+    return nullptr;
+  }
+
+  void _Push_local(_Worker& __w, __operation* __op)
+  {
+    {
+      lock_guard<mutex> __lock(__w._M_mutex);
+      __w._M_queue._Push(__op);
+      ++__w._M_size;
+    }
+
+    _Wake_idle_worker();
+  }
+
+  void _Push_local(_Worker& __w, __op_queue<__operation>& __ops)
+  {
+    {
+      lock_guard<mutex> __lock(__w._M_mutex);
+      __w._M_size += _Splice(__w._M_queue, __ops);
+    }
+
+    _Wake_idle_worker();
+  }
+
+  void _Push_shared(__op_queue<__operation>& __ops)
+  {
+    _Lock_guard __lock(this);
+    size_t __n = _Splice(_M_queue, __ops);
+    _M_queue_size += __n;
+    _Wake_idle_workers_locked(__n);
+  }
+
+  // Wake as many waiting threads as there are new operations for them to run.
+  // Must be called with the lock held.
+  void _Wake_idle_workers_locked(size_t __n)
+  {
+    size_t __idle = _M_idle_workers;
+    if (__n >= __idle)
+    {
+      if (__idle > 0)
+        _M_condition.notify_all();
+    }
+    else
+    {
+      while (__n-- > 0)
+        _M_condition.notify_one();
+    }
+  }
+
+  // Queue an operation posted from within the scheduler, for which work has
+  // already been counted.
+  void _Publish(_Context& __ctx, __operation* __op)
+  {
+    if (_M_one_thread)
+    {
+      __ctx._M_private_queue._Push(__op);
+      return;
+    }
+
+    if (__ctx._M_worker)
+    {
+      _Push_local(*__ctx._M_worker, __op);
+      return;
+    }
+
+    _Lock_guard __lock(this);
+    _M_queue._Push(__op);
+    ++_M_queue_size;
+    if (_M_idle_workers > 0)
       _M_condition.notify_one();
+  }
+
+  // Must be called with the lock held.
+  void _Add_next_slot_owner(_Context& __ctx)
+  {
+    __ctx._M_next_slot_owner = _M_next_slot_owners;
+    _M_next_slot_owners = &__ctx;
+  }
+
+  // Must be called with the lock held.
+  void _Remove_next_slot_owner(_Context& __ctx)
+  {
+    _Context** __p = &_M_next_slot_owners;
+    while (*__p != &__ctx)
+      __p = &(*__p)->_M_next_slot_owner;
+    *__p = __ctx._M_next_slot_owner;
+  }
+
+  // Move the operations held in other threads' slots to the shared queue, so
+  // that a thread about to wait runs them instead. A handler that blocks until
+  // its follow-up has run would otherwise never see it complete. Must be called
+  // with the lock held, after the calling thread has been counted in
+  // _M_idle_workers. Returns true if any operation was moved.
+  bool _Publish_next_ops(_Context& __ctx)
+  {
+    size_t __n = 0;
+    for (_Context* __c = _M_next_slot_owners; __c; __c = __c->_M_next_slot_owner)
+    {
+      if (__c == &__ctx || __c->_M_next_op.load() == nullptr)
+        continue;
+      if (__operation* __op = __c->_M_next_op.exchange(nullptr))
+      {
+        _M_queue._Push(__op);
+        ++__n;
+      }
+    }
+    _M_queue_size += __n;
+    return __n > 0;
+  }
+
+  // Link a new operation onto the end of a queue, so that the queue may later
+  // be spliced into the scheduler in a single step.
+  template <class _F, class _A>
+  static void _Link_op(__op_queue<__operation>& __ops, _F&& __f, const _A& __a);
+
+  void _Post_ops(__op_queue<__operation>& __ops, size_t __n);
+
+  // Called after making work visible in a local queue or the injection queue.
+  // The sequentially consistent accesses to the queue and _M_idle_workers
+  // ensure that either a thread about to wait sees the new work, or we see the
+  // waiting thread.
+  void _Wake_idle_worker()
+  {
+    if (_M_idle_workers > 0)
+    {
+      _Lock_guard __lock(this);
+      _M_condition.notify_one();
+    }
+  }
+
+  bool _Spins() const
+  {
+    return _M_spin_count > 0 || _M_yield_count > 0;
+  }
+
+  static void _Pause()
+  {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__aarch64__) || defined(__arm__))
+    __asm__ __volatile__("yield");
+#endif
+  }
+
+  // Whether there may be work for an idle thread. Called without the lock, so
+  // the answer is only a hint.
+  bool _Work_available() const
+  {
+    return _M_queue_size.load(memory_order_relaxed) > 0
+      || !_M_injected._Empty()
+      || (_M_workers && _Has_local_work());
+  }
+
+  // Wait for work without blocking, first by spinning and then by yielding the
+  // processor. Returns true if work may have arrived, or false if the thread
+  // should park. A thread is not counted as idle while spinning, so posting
+  // threads do not need to notify it.
+  bool _Spin_for_work() const
+  {
+    for (size_t __i = 0; __i < _M_spin_count + _M_yield_count; ++__i)
+    {
+      if (_M_stopped.load(memory_order_relaxed))
+        return false;
+      if (_Work_available())
+        return true;
+      if (__i < _M_spin_count)
+        _Pause();
+      else
+        this_thread::yield();
+    }
+
+    return _Work_available();
+  }
+
+  bool _Has_local_work() const
+  {
+    for (size_t __i = 0; __i < _M_num_workers; ++__i)
+      if (_M_workers[__i]._M_size > 0)
+        return true;
+    return false;
+  }
+
+  // Find the next operation for a thread running a work-stealing scheduler.
+  // The thread's own queue is checked first, then the shared queue, and
+  // finally the queues of the other threads.
+  __operation* _Next_stealing_op(_Context& __ctx)
+  {
+    if (_M_stopped.load(memory_order_relaxed))
+      return nullptr;
+
+    if (_Worker* __w = __ctx._M_worker)
+    {
+      if (__w->_M_size.load(memory_order_relaxed) > 0)
+      {
+        lock_guard<mutex> __lock(__w->_M_mutex);
+        if (__operation* __op = __w->_M_queue._Front())
+        {
+          __w->_M_queue._Pop();
+          __w->_M_size.fetch_sub(1, memory_order_relaxed);
+          return __op;
+        }
+      }
+    }
+
+    __op_queue<__operation> __batch;
+    __operation* __op = nullptr;
+    {
+      _Lock_guard __lock(this);
+      if ((__op = _M_queue._Front()) != nullptr)
+      {
+        _M_queue._Pop();
+        --_M_queue_size;
+        _Record_progress();
+
+        if (__ctx._M_worker)
+        {
+          for (size_t __extra = _Batch_extra(__ctx, _M_queue_size); __extra > 0; --__extra)
+          {
+            __operation* __next = _M_queue._Front();
+            _M_queue._Pop();
+            __batch._Push(__next);
+            --_M_queue_size;
+          }
+        }
+
+        if (!_M_queue._Empty() && _M_idle_workers > 0)
+          _M_condition.notify_one();
+      }
+    }
+
+    if (__op)
+    {
+      // Surplus operations go to the local queue, where peers may steal them.
+      if (!__batch._Empty())
+        _Push_local(*__ctx._M_worker, __batch);
+      return __op;
+    }
+
+    return _Steal(__ctx);
+  }
+
+  // Take up to half of another thread's queued operations. Surplus operations
+  // are moved to the thief's own queue, where they may in turn be stolen.
+  __operation* _Steal(_Context& __ctx)
+  {
+    // With NUMA-local queues, peers on the thief's own node are tried first.
+    size_t __self = __ctx._M_worker ? __ctx._M_worker->_M_index : 0;
+    size_t __node = __ctx._M_worker ? __ctx._M_worker->_M_node.load(memory_order_relaxed) : 0;
+    for (size_t __i = _M_numa_local ? 0 : _M_num_workers; __i < 2 * _M_num_workers; ++__i)
+    {
+      _Worker& __victim = _M_workers[(__self + __i + 1) % _M_num_workers];
+      if (&__victim == __ctx._M_worker)
+        continue;
+
+      bool __same_node = __victim._M_node.load(memory_order_relaxed) == __node;
+      if (__i < _M_num_workers ? !__same_node : (_M_numa_local && __same_node))
+        continue;
+
+      if (__victim._M_size.load(memory_order_relaxed) == 0)
+        continue;
+
+      __op_queue<__operation> __ops;
+      {
+        lock_guard<mutex> __lock(__victim._M_mutex);
+        size_t __size = __victim._M_size.load(memory_order_relaxed);
+        size_t __n = __ctx._M_worker ? (__size + 1) / 2 : 1;
+        for (size_t __j = 0; __j < __n; ++__j)
+        {
+          __operation* __op = __victim._M_queue._Front();
+          __victim._M_queue._Pop();
+          __ops._Push(__op);
+        }
+        __victim._M_size.fetch_sub(__n, memory_order_relaxed);
+      }
+
+      if (__operation* __op = __ops._Front())
+      {
+        __ops._Pop();
+        if (!__ops._Empty())
+          _Push_local(*__ctx._M_worker, __ops);
+        return __op;
+      }
+    }
+
+    return nullptr;
+  }
 
+  // Move the operations of expired timers to the shared queue, and note when
+  // the timers must next be checked. Must be called with the lock held.
+  // Returns the number of operations moved, and sets __wait to the time until
+  // the next timer expires, or to the maximum duration if none is due.
+  size_t _Collect_timers(chrono::steady_clock::duration& __wait)
+  {
+    __op_queue<__operation> __ops;
+    __wait = _M_timers->_Get_ready_ops(__ops);
+
+    chrono::steady_clock::rep __check = (numeric_limits<chrono::steady_clock::rep>::max)();
+    if (__wait != (chrono::steady_clock::duration::max)())
+      __check = (chrono::steady_clock::now() + __wait).time_since_epoch().count();
+    _M_timer_check.store(__check, memory_order_relaxed);
+
+    // Expired timers' operations run like any function object submitted to
+    // the scheduler, so they must be counted as work.
+    size_t __n = 0;
+    while (__operation* __op = __ops._Front())
+    {
+      __ops._Pop();
+      _Stamp(__op);
+      _M_queue._Push(__op);
+      ++__n;
+    }
+
+    if (__n > 0)
+    {
+      _M_outstanding_work += __n;
+      _M_queue_size += __n;
+      _Wake_idle_workers_locked(__n);
+    }
+
+    return __n;
+  }
+
+  // Check the timers if one may have expired, so that timers run even while
+  // the scheduler's threads are too busy to wait.
+  void _Poll_timers(_Context& __ctx)
+  {
+    if (!_M_timers || chrono::steady_clock::now().time_since_epoch().count()
+        < _M_timer_check.load(memory_order_relaxed))
+      return;
+
+    chrono::steady_clock::duration __wait;
+    if (__ctx._M_lock.owns_lock())
+    {
+      _Collect_timers(__wait);
+    }
+    else
+    {
+      _Acquire(__ctx._M_lock);
+      _Collect_timers(__wait);
+      __ctx._M_lock.unlock();
+    }
+  }
+
+  // Wait on the condition variable until it is notified, until __abs_time, or
+  // until __timeout has elapsed. Must be called with the lock held. Returns
+  // cv_status::timeout only when __abs_time has passed.
+  template <class _Clock, class _Duration>
+  cv_status _Wait_until(_Context& __ctx,
+    const chrono::time_point<_Clock, _Duration>& __abs_time,
+    const chrono::steady_clock::duration& __timeout)
+  {
+    const bool __forever = (__abs_time == (chrono::time_point<_Clock, _Duration>::max)());
+
+    if (__timeout != (chrono::steady_clock::duration::max)()
+        && (__forever || __abs_time - _Clock::now() > __timeout))
+    {
+      _M_condition.wait_until(__ctx._M_lock, chrono::steady_clock::now() + __timeout);
+      return cv_status::no_timeout;
+    }
+
+    if (__forever)
+    {
+      _M_condition.wait(__ctx._M_lock);
+      return cv_status::no_timeout;
+    }
+
+    return _M_condition.wait_until(__ctx._M_lock, __abs_time);
+  }
+
+  // Wait for work, or until __abs_time. A scheduler that runs its own timers
+  // waits no longer than until the first of them expires, and instead of
+  // waiting moves the operations of expired timers to the shared queue. Must
+  // be called with the lock held.
+  template <class _Clock, class _Duration>
+  cv_status _Wait(_Context& __ctx, const chrono::time_point<_Clock, _Duration>& __abs_time)
+  {
+    chrono::steady_clock::duration __timeout = (chrono::steady_clock::duration::max)();
+    if (_M_timers && _Collect_timers(__timeout) > 0)
+      return cv_status::no_timeout;
+    return _Wait_until(__ctx, __abs_time, __timeout);
+  }
+
+  // Wait for the timers of a single-threaded scheduler that has nothing else
+  // to run, or for work submitted from another thread. Returns true if there
+  // are operations to run, and false if no timer is due to expire before
+  // __abs_time.
+  template <class _Clock, class _Duration>
+  bool _Wait_for_timers(_Context& __ctx,
+    const chrono::time_point<_Clock, _Duration>& __abs_time)
+  {
+    _Acquire(__ctx._M_lock);
+    ++_M_idle_workers;
+
+    cv_status __status = cv_status::no_timeout;
+    while (_M_queue._Empty() && _M_injected._Empty()
+        && !_M_stopped && __status == cv_status::no_timeout)
+    {
+      chrono::steady_clock::duration __timeout;
+      if (_Collect_timers(__timeout) > 0 || __timeout == (chrono::steady_clock::duration::max)())
+        break;
+      __status = _Wait_until(__ctx, __abs_time, __timeout);
+    }
+
+    --_M_idle_workers;
+    bool __result = !_M_stopped && (!_M_queue._Empty() || !_M_injected._Empty());
     __ctx._M_lock.unlock();
-    __ctx._M_work_delta = -1;
+    return __result;
+  }
 
-    __op->_Complete();
-    return 1;
+  template <class _Clock, class _Duration>
+  bool _Park(_Context& __ctx, const chrono::time_point<_Clock, _Duration>& __abs_time)
+  {
+    _Acquire(__ctx._M_lock);
+    ++_M_idle_workers;
+
+    bool __timed_out = false;
+    while (!_M_stopped && _M_queue._Empty() && !_Has_local_work()
+        && !__timed_out && !_Publish_next_ops(__ctx))
+      __timed_out = (_Wait(__ctx, __abs_time) == cv_status::timeout);
+
+    --_M_idle_workers;
+    bool __result = !_M_stopped && !__timed_out;
+    __ctx._M_lock.unlock();
+    return __result;
   }
 
   mutable mutex _M_mutex;
   condition_variable _M_condition;
   __op_queue<__operation> _M_queue;
+  atomic<size_t> _M_queue_size;
+
+  // Operations submitted from outside a single-threaded scheduler.
+  __op_mpsc_queue<__operation> _M_injected;
+
+  // The shared work count is kept apart from the lock and the queue, as it is
+  // updated by threads submitting work from outside the scheduler.
+  char _M_work_padding_before[64];
   atomic<ptrdiff_t> _M_outstanding_work;
-  bool _M_stopped;
+  char _M_work_padding_after[64];
+
+  atomic<bool> _M_stopped;
   const bool _M_one_thread;
+  const bool _M_single_threaded;
+  const size_t _M_next_slot_budget;
+  const size_t _M_batch_size;
+  const size_t _M_spin_count;
+  const size_t _M_yield_count;
+  unique_ptr<_Worker[]> _M_workers;
+  size_t _M_num_workers;
+  atomic<size_t> _M_idle_workers;
+  _Context* _M_next_slot_owners;
+  const bool _M_numa_local;
+  atomic<size_t> _M_next_submit;
+  const bool _M_track_progress;
+  atomic<chrono::steady_clock::rep> _M_last_progress;
+  const bool _M_strand_affinity;
+  atomic<uint64_t> _M_migrations;
+
+  // Timers run by the scheduler's threads, and the time at which they must
+  // next be checked.
+  __reactor_timers* _M_timers;
+  atomic<chrono::steady_clock::rep> _M_timer_check;
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+  mutable __scheduler_statistics _M_statistics;
+#endif
 };
 
 template <class _Func, class _Allocator>
@@ -345,6 +1432,79 @@ private:
   _Allocator _M_allocator;
 };
 
+// An operation placed in a slot of the creating thread's __op_ring. The slot
+// is given back before the function is invoked, as the heap block is for
+// __scheduler_op.
+template <class _Func>
+class __scheduler_ring_op
+  : public __operation
+{
+public:
+  __scheduler_ring_op(const __scheduler_ring_op&) = delete;
+  __scheduler_ring_op& operator=(const __scheduler_ring_op&) = delete;
+
+  template <class _F> explicit __scheduler_ring_op(_F&& __f)
+    : _M_func(forward<_F>(__f))
+  {
+  }
+
+  virtual void _Complete()
+  {
+    _Func __tmp(std::move(_M_func));
+    _Destroy();
+    std::move(__tmp)();
+  }
+
+  virtual void _Destroy()
+  {
+    void* __slot = this;
+    this->~__scheduler_ring_op();
+    __op_ring<>::_Release(__slot);
+  }
+
+private:
+  _Func _M_func;
+};
+
+template <class _Allocator>
+struct __is_default_allocator : false_type {};
+
+template <class _T>
+struct __is_default_allocator<allocator<_T>> : true_type {};
+
+template <class _Func, class _F, class _A>
+inline __scheduler::_Op_ptr __scheduler::_Make_op(_F&& __f, const _A& __a)
+{
+  typedef integral_constant<bool, __is_default_allocator<_A>::value
+    && __op_ring<>::_Fits<__scheduler_ring_op<_Func>>::value
+    && is_nothrow_move_constructible<_Func>::value> _Use_ring;
+  return _Make_op<_Func>(forward<_F>(__f), __a, _Use_ring());
+}
+
+template <class _Func, class _F, class _A>
+inline __scheduler::_Op_ptr __scheduler::_Make_op(_F&& __f, const _A& __a, true_type)
+{
+  void* __slot = __op_ring<>::_Acquire();
+  if (!__slot)
+    return _Make_op<_Func>(forward<_F>(__f), __a, false_type());
+
+  try
+  {
+    return _Op_ptr(new (__slot) __scheduler_ring_op<_Func>(forward<_F>(__f)));
+  }
+  catch (...)
+  {
+    __op_ring<>::_Release(__slot);
+    throw;
+  }
+}
+
+template <class _Func, class _F, class _A>
+inline __scheduler::_Op_ptr __scheduler::_Make_op(_F&& __f, const _A& __a, false_type)
+{
+  return _Op_ptr(_Allocate_small_block<__scheduler_op<_Func, _A>>(__a, forward<_F>(__f), __a).release());
+}
+
 template <class _F, class _A> void __scheduler::_Dispatch(_F&& __f, const _A& __a)
 {
   typedef typename decay<_F>::type _Func;
@@ -361,13 +1521,34 @@ template <class _F, class _A> void __scheduler::_Dispatch(_F&& __f, const _A& __
 template <class _F, class _A> void __scheduler::_Post(_F&& __f, const _A& __a)
 {
   typedef typename decay<_F>::type _Func;
-  auto __op(_Allocate_small_block<__scheduler_op<_Func, _A>>(__a, forward<_F>(__f), __a));
+  const __worker_affinity* __affinity = _M_strand_affinity ? __affinity_of(__f) : nullptr;
+  _Op_ptr __op(_Make_op<_Func>(forward<_F>(__f), __a));
+  _Stamp(__op.get());
 
   _Context* __ctx = _Call_stack::_Contains(this);
+  _Worker* __affine = _Affine_worker(__affinity, __ctx);
   if (__ctx == nullptr)
   {
     ++_M_outstanding_work;
   }
+  else if (_M_next_slot_budget > 0 && !__affine
+      && _M_idle_workers.load(memory_order_relaxed) == 0)
+  {
+    // The new operation takes the slot, and any operation it displaces is
+    // queued as if it had just been posted.
+    _Add_work(*__ctx, 1);
+    if (__operation* __displaced = __ctx->_M_next_op.exchange(__op.release()))
+      _Publish(*__ctx, __displaced);
+
+    // A peer that went idle before the slot was filled may not have seen the
+    // occupant, so it is queued where that peer can run it. The sequentially
+    // consistent accesses to the slot and _M_idle_workers pair with those in
+    // _Publish_next_ops.
+    if (_M_idle_workers > 0)
+      if (__operation* __occupant = __ctx->_M_next_op.exchange(nullptr))
+        _Publish(*__ctx, __occupant);
+    return;
+  }
   else if (_M_one_thread)
   {
     ++__ctx->_M_work_delta;
@@ -376,19 +1557,37 @@ template <class _F, class _A> void __scheduler::_Post(_F&& __f, const _A& __a)
     __op.release();
     return;
   }
-  else if (__ctx->_M_work_delta < 0)
+  else
   {
-    ++__ctx->_M_work_delta;
+    // The new operation may complete on another thread before the current
+    // handler returns, so it must not borrow the running operation's work
+    // count. Doing so lets the count reach zero while deferred operations are
+    // still waiting in the private queue. Work released by operations that
+    // have already completed is safe to reuse.
+    _Add_work(*__ctx, 1);
   }
-  else
+
+  if (_Worker* __w = __affine ? __affine : __ctx ? __ctx->_M_worker : _Node_worker())
   {
-    ++_M_outstanding_work;
+    _Push_local(*__w, __op.get());
+
+    __op.release();
+    return;
+  }
+
+  if (_M_one_thread)
+  {
+    _Inject(__op.get());
+
+    __op.release();
+    return;
   }
 
-  lock_guard<mutex> lock(_M_mutex);
+  _Lock_guard __lock(this);
 
   _M_queue._Push(__op.get());
-  if (_M_queue._Front() == __op.get())
+  ++_M_queue_size;
+  if (_M_idle_workers > 0)
     _M_condition.notify_one();
 
   __op.release();
@@ -397,13 +1596,22 @@ template <class _F, class _A> void __scheduler::_Post(_F&& __f, const _A& __a)
 template <class _F, class _A> void __scheduler::_Defer(_F&& __f, const _A& __a)
 {
   typedef typename decay<_F>::type _Func;
-  auto __op(_Allocate_small_block<__scheduler_op<_Func, _A>>(__a, forward<_F>(__f), __a));
+  const __worker_affinity* __affinity = _M_strand_affinity ? __affinity_of(__f) : nullptr;
+  _Op_ptr __op(_Make_op<_Func>(forward<_F>(__f), __a));
+  _Stamp(__op.get());
 
   _Context* __ctx = _Call_stack::_Contains(this);
+  _Worker* __affine = _Affine_worker(__affinity, __ctx);
   if (__ctx == nullptr)
   {
     ++_M_outstanding_work;
   }
+  else if (__affine)
+  {
+    // The operation is made visible to another thread straight away, so it
+    // needs its own work count, as in _Post.
+    _Add_work(*__ctx, 1);
+  }
   else
   {
     ++__ctx->_M_work_delta;
@@ -413,15 +1621,106 @@ template <class _F, class _A> void __scheduler::_Defer(_F&& __f, const _A& __a)
     return;
   }
 
-  lock_guard<mutex> lock(_M_mutex);
+  if (_Worker* __w = __affine ? __affine : _Node_worker())
+  {
+    _Push_local(*__w, __op.get());
+
+    __op.release();
+    return;
+  }
+
+  if (_M_one_thread)
+  {
+    _Inject(__op.get());
+
+    __op.release();
+    return;
+  }
+
+  _Lock_guard __lock(this);
 
   _M_queue._Push(__op.get());
-  if (_M_queue._Front() == __op.get())
+  ++_M_queue_size;
+  if (_M_idle_workers > 0)
     _M_condition.notify_one();
 
   __op.release();
 }
 
+template <class _F, class _A>
+void __scheduler::_Link_op(__op_queue<__operation>& __ops, _F&& __f, const _A& __a)
+{
+  typedef typename decay<_F>::type _Func;
+  _Op_ptr __op(_Make_op<_Func>(forward<_F>(__f), __a));
+  _Stamp(__op.get());
+  __ops._Push(__op.release());
+}
+
+inline void __scheduler::_Post_ops(__op_queue<__operation>& __ops, size_t __n)
+{
+  if (__n == 0)
+    return;
+
+  _Context* __ctx = _Call_stack::_Contains(this);
+  if (__ctx && _M_one_thread)
+  {
+    __ctx->_M_work_delta += __n;
+    __ctx->_M_private_queue._Push(__ops);
+    return;
+  }
+
+  if (__ctx)
+    _Add_work(*__ctx, __n);
+  else
+    _M_outstanding_work += __n;
+
+  if (_Worker* __w = __ctx ? __ctx->_M_worker : _Node_worker())
+  {
+    {
+      lock_guard<mutex> __lock(__w->_M_mutex);
+      __w->_M_queue._Push(__ops);
+      __w->_M_size += __n;
+    }
+
+    if (_M_idle_workers > 0)
+    {
+      _Lock_guard __lock(this);
+      _Wake_idle_workers_locked(__n);
+    }
+    return;
+  }
+
+  if (_M_one_thread)
+  {
+    _Inject(__ops);
+    return;
+  }
+
+  _Lock_guard __lock(this);
+  _M_queue._Push(__ops);
+  _M_queue_size += __n;
+  _Wake_idle_workers_locked(__n);
+}
+
+template <class _Iter, class _A>
+void __scheduler::_Post_range(_Iter __first, _Iter __last, const _A& __a)
+{
+  __op_queue<__operation> __ops;
+  size_t __n = 0;
+  for (; __first != __last; ++__first, ++__n)
+    _Link_op(__ops, *__first, __a);
+  _Post_ops(__ops, __n);
+}
+
+template <class _A, class... _F>
+void __scheduler::_Post_each(const _A& __a, _F&&... __f)
+{
+  __op_queue<__operation> __ops;
+  int __expand[] = { 0, (_Link_op(__ops, forward<_F>(__f), __a), 0)... };
+  (void)__expand;
+  _Post_ops(__ops, sizeof...(_F));
+}
+
 } // inline namespace concurrency_v1
 } // namespace experimental
 } // namespace std
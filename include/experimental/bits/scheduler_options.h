@@ -0,0 +1,133 @@
+//
+// scheduler_options.h
+// ~~~~~~~~~~~~~~~~~~~
+// Options used to tune scheduler-based execution contexts.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_SCHEDULER_OPTIONS_H
+#define EXECUTORS_EXPERIMENTAL_BITS_SCHEDULER_OPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// Policies for binding the threads created by an execution context to
+// processors.
+
+enum class thread_placement
+{
+  // Threads may run on any processor.
+  none,
+
+  // Thread i is bound to scheduler_options::cpus[i % cpus.size()].
+  cpu_list,
+
+  // Each thread is bound to a different physical core, ignoring additional
+  // hardware threads on the same core.
+  physical_core,
+
+  // Threads are distributed round-robin across NUMA nodes, and each may run on
+  // any processor of its node.
+  numa_node
+};
+
+// Options that control how a scheduler-based execution context, such as
+// thread_pool, queues and runs function objects.
+
+struct scheduler_options
+{
+  // When true, each thread running the scheduler owns a local run queue.
+  // Function objects posted or deferred from within the scheduler are added to
+  // the calling thread's local queue, idle threads steal work from their peers,
+  // and the shared queue is used only for submissions from other threads.
+  bool work_stealing = false;
+
+  // The maximum number of operations a thread takes from the shared queue in a
+  // single critical section. The thread runs the extra operations without
+  // re-acquiring the lock, but never takes more than half of what remains, so
+  // that other threads are still woken to share the load.
+  size_t batch_size = 1;
+
+  // How an idle thread waits for new work before blocking on the scheduler's
+  // condition variable. The thread first checks for work spin_count times,
+  // pausing the processor between checks, then yields its time slice up to
+  // yield_count times. Only then does it park, at which point a subsequent
+  // post must wake it. Spinning trades processor time for lower wakeup latency.
+  size_t spin_count = 0;
+  size_t yield_count = 0;
+
+  // When greater than zero, the function object most recently posted by a
+  // running handler is held in a slot owned by the handler's thread, and runs
+  // on that thread as soon as the handler returns rather than going to the
+  // back of the queue. A handler that posts one follow-up and returns thus
+  // passes its warm cache to the follow-up and takes no lock. After
+  // next_slot_budget consecutive operations have run from the slot, its
+  // occupant is queued normally so that other function objects are not
+  // starved. The slot is bypassed while other threads are idle, and a thread
+  // that goes idle takes over any occupied slots, so a handler that blocks on
+  // its follow-up does not stall it. The slot is not used by a single_threaded
+  // scheduler.
+  size_t next_slot_budget = 0;
+
+  // A promise that a scheduler constructed with a concurrency hint of 1 is
+  // only ever run, and posted to from within, on one thread at a time. Its run
+  // loop then takes no lock and updates no shared state for each function
+  // object, and its run functions return as soon as no function objects are
+  // queued, as there is no other thread to wait for. Ignored for other hints,
+  // and by thread_pool.
+  bool single_threaded = false;
+
+  // How a thread_pool binds its threads to processors. Placement is a hint and
+  // is ignored on platforms that do not support it.
+  thread_placement placement = thread_placement::none;
+
+  // The processors used by thread_placement::cpu_list.
+  vector<unsigned> cpus;
+
+  // When true, and work stealing is enabled, function objects submitted from
+  // outside the scheduler are queued on a thread running on the submitter's
+  // NUMA node, so that they preferentially run on that node. Idle threads also
+  // steal from peers on their own node before looking further afield.
+  bool numa_local_queues = false;
+
+  // When true, and work stealing is enabled, a strand whose function objects
+  // are run by the scheduler is resumed on the thread that last ran it, so
+  // that state used under the strand stays in that thread's cache. The strand
+  // is queued on that thread's local queue, from which idle threads may still
+  // steal it when the thread is busy.
+  bool strand_affinity = false;
+
+  // When true, the timers of the execution context are run by the threads
+  // that run the scheduler, rather than by a thread of their own. A thread
+  // waiting for work waits no longer than until the earliest expiry, and then
+  // queues the expired waits itself, so a handler for the same context is run
+  // without a hop through another thread. Timers only expire while at least
+  // one thread is running the scheduler.
+  bool run_timers = false;
+
+  // When greater than the number of threads a thread_pool is constructed with,
+  // the pool is elastic. It starts an extra thread, up to max_threads in total,
+  // whenever no thread is idle and either at least grow_queue_depth operations
+  // are waiting in the shared queue or none has been taken from it for
+  // grow_latency. An extra thread exits when it finds no work for idle_timeout,
+  // so the pool shrinks back to its original size.
+  size_t max_threads = 0;
+  size_t grow_queue_depth = 16;
+  chrono::steady_clock::duration grow_latency = chrono::milliseconds(10);
+  chrono::steady_clock::duration idle_timeout = chrono::seconds(10);
+};
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
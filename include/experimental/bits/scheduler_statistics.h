@@ -0,0 +1,210 @@
+//
+// scheduler_statistics.h
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Statistics gathered by scheduler-based execution contexts.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_SCHEDULER_STATISTICS_H
+#define EXECUTORS_EXPERIMENTAL_BITS_SCHEDULER_STATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// A histogram of durations with logarithmic buckets. Bucket i counts samples
+// of at least 2^i nanoseconds but less than 2^(i+1) nanoseconds, except that
+// bucket 0 also counts samples of less than one nanosecond and the last bucket
+// counts everything longer.
+
+struct scheduler_histogram
+{
+  static constexpr size_t bucket_count = 32;
+
+  array<uint64_t, bucket_count> buckets = {};
+  uint64_t count = 0;
+  chrono::nanoseconds total = chrono::nanoseconds::zero();
+};
+
+// A snapshot of the statistics gathered by a scheduler-based execution
+// context. Statistics are gathered only when the program is compiled with
+// EXECUTORS_ENABLE_STATISTICS defined. Otherwise all values are zero.
+
+struct scheduler_statistics
+{
+  // Number of operations waiting to be run.
+  size_t queue_depth = 0;
+
+  // Number of operations run since the execution context was created.
+  uint64_t operations_executed = 0;
+
+  // Number of operations run by each thread that has run the execution
+  // context. Threads are not identified, and where there are more threads than
+  // can be tracked separately, some counts are combined.
+  vector<uint64_t> operations_executed_per_thread;
+
+  // Time from an operation being submitted until it starts to run.
+  scheduler_histogram enqueue_to_start;
+
+  // Time taken to run each operation.
+  scheduler_histogram execution_time;
+
+  // Time spent waiting to acquire the scheduler's lock, when the lock was not
+  // immediately available.
+  scheduler_histogram lock_wait;
+
+  // Number of times a strand ran on a different thread from the one that last
+  // ran it. Counted only when work stealing is enabled, but whether or not
+  // EXECUTORS_ENABLE_STATISTICS is defined.
+  uint64_t strand_migrations = 0;
+};
+
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+
+// A histogram that may be updated and read concurrently.
+
+class __atomic_histogram
+{
+public:
+  __atomic_histogram()
+  {
+    for (auto& __b: _M_buckets)
+      __b.store(0, memory_order_relaxed);
+    _M_count.store(0, memory_order_relaxed);
+    _M_total.store(0, memory_order_relaxed);
+  }
+
+  __atomic_histogram(const __atomic_histogram&) = delete;
+  __atomic_histogram& operator=(const __atomic_histogram&) = delete;
+
+  void _Record(chrono::steady_clock::duration __d)
+  {
+    int64_t __ns = chrono::duration_cast<chrono::nanoseconds>(__d).count();
+    if (__ns < 0)
+      __ns = 0;
+    _M_buckets[_Bucket(static_cast<uint64_t>(__ns))].fetch_add(1, memory_order_relaxed);
+    _M_count.fetch_add(1, memory_order_relaxed);
+    _M_total.fetch_add(__ns, memory_order_relaxed);
+  }
+
+  // Add the recorded samples to __to.
+  void _Read(scheduler_histogram& __to) const
+  {
+    for (size_t __i = 0; __i < scheduler_histogram::bucket_count; ++__i)
+      __to.buckets[__i] += _M_buckets[__i].load(memory_order_relaxed);
+    __to.count += _M_count.load(memory_order_relaxed);
+    __to.total += chrono::nanoseconds(_M_total.load(memory_order_relaxed));
+  }
+
+private:
+  static size_t _Bucket(uint64_t __ns)
+  {
+    size_t __b = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    if (__ns > 1)
+      __b = 63 - __builtin_clzll(__ns);
+#else
+    while (__ns >>= 1)
+      ++__b;
+#endif
+    return __b < scheduler_histogram::bucket_count ? __b : scheduler_histogram::bucket_count - 1;
+  }
+
+  atomic<uint64_t> _M_buckets[scheduler_histogram::bucket_count];
+  atomic<uint64_t> _M_count;
+  atomic<int64_t> _M_total;
+};
+
+// Statistics are accumulated in per-thread shards, padded so that no two
+// shards share a cache line, and merged when read. A thread is assigned a
+// shard on first use, so threads only contend when there are more of them
+// than shards.
+
+class __scheduler_statistics
+{
+public:
+  __scheduler_statistics()
+    : _M_shards(new _Shard[_S_num_shards])
+  {
+  }
+
+  void _Record_start(chrono::steady_clock::duration __queued)
+  {
+    _Shard& __s = _Current_shard();
+    __s._M_executed.fetch_add(1, memory_order_relaxed);
+    __s._M_enqueue_to_start._Record(__queued);
+  }
+
+  void _Record_execution(chrono::steady_clock::duration __d)
+  {
+    _Current_shard()._M_execution_time._Record(__d);
+  }
+
+  void _Record_lock_wait(chrono::steady_clock::duration __d)
+  {
+    _Current_shard()._M_lock_wait._Record(__d);
+  }
+
+  void _Read(scheduler_statistics& __stats) const
+  {
+    for (size_t __i = 0; __i < _S_num_shards; ++__i)
+    {
+      const _Shard& __s = _M_shards[__i];
+      uint64_t __executed = __s._M_executed.load(memory_order_relaxed);
+      if (__executed > 0)
+      {
+        __stats.operations_executed += __executed;
+        __stats.operations_executed_per_thread.push_back(__executed);
+      }
+      __s._M_enqueue_to_start._Read(__stats.enqueue_to_start);
+      __s._M_execution_time._Read(__stats.execution_time);
+      __s._M_lock_wait._Read(__stats.lock_wait);
+    }
+  }
+
+private:
+  static constexpr size_t _S_num_shards = 64;
+
+  struct _Shard
+  {
+    _Shard()
+    {
+      _M_executed.store(0, memory_order_relaxed);
+    }
+
+    atomic<uint64_t> _M_executed;
+    __atomic_histogram _M_enqueue_to_start;
+    __atomic_histogram _M_execution_time;
+    __atomic_histogram _M_lock_wait;
+    char _M_padding[64];
+  };
+
+  _Shard& _Current_shard()
+  {
+    static atomic<size_t> __next_index(0);
+    static thread_local size_t __index = __next_index.fetch_add(1, memory_order_relaxed);
+    return _M_shards[__index % _S_num_shards];
+  }
+
+  unique_ptr<_Shard[]> _M_shards;
+};
+
+#endif // defined(EXECUTORS_ENABLE_STATISTICS)
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
@@ -0,0 +1,362 @@
+//
+// shared_strand.h
+// ~~~~~~~~~~~~~~~
+// Strand that allows shared handlers to run concurrently with each other.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_SHARED_STRAND_H
+#define EXECUTORS_EXPERIMENTAL_BITS_SHARED_STRAND_H
+
+#include <mutex>
+#include <experimental/bits/call_stack.h>
+#include <experimental/bits/operation.h>
+#include <experimental/bits/small_block_recycler.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+class __shared_strand_op
+  : public __operation
+{
+public:
+  const bool _M_exclusive;
+
+protected:
+  explicit __shared_strand_op(bool __exclusive)
+    : _M_exclusive(__exclusive)
+  {
+  }
+};
+
+// Operations wait in a single queue in the order they were submitted. The
+// operation at the front of the queue starts as soon as it is compatible with
+// those already running: a shared operation when no exclusive operation is
+// running, and an exclusive operation when nothing is running. Each operation
+// that starts is handed to an invoker, and the invoker that finishes an
+// operation starts whatever has become ready as a result.
+
+struct __shared_strand_impl final
+  : __strand_node
+{
+  explicit __shared_strand_impl(__strand_service& __s)
+  {
+    _Register(__s);
+  }
+
+  ~__shared_strand_impl()
+  {
+    _Unregister();
+  }
+
+  // Queue an operation, returning it if it may start straight away.
+  __shared_strand_op* _Enqueue(__shared_strand_op* __op)
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    bool __was_empty = _M_waiting_queue._Empty();
+    _M_waiting_queue._Push(__op);
+
+    // Anything already waiting is blocked, so only a lone operation can start.
+    __op_queue<__shared_strand_op> __ready;
+    if (__was_empty)
+      _Start(__ready);
+    __op = __ready._Front();
+    __ready._Pop();
+    return __op;
+  }
+
+  // Note that an operation has finished, moving the operations that may now
+  // start to __ready.
+  void _Finish(bool __exclusive, __op_queue<__shared_strand_op>& __ready)
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    if (__exclusive)
+      _M_exclusive = false;
+    else
+      --_M_shared;
+    _Start(__ready);
+  }
+
+  void _Shutdown(__op_queue<__operation>& __ops)
+  {
+    lock_guard<mutex> __lock(_M_mutex);
+    __ops._Push(_M_waiting_queue);
+  }
+
+private:
+  void _Start(__op_queue<__shared_strand_op>& __ready)
+  {
+    while (__shared_strand_op* __op = _M_waiting_queue._Front())
+    {
+      if (_M_exclusive)
+        return;
+
+      if (__op->_M_exclusive)
+      {
+        if (_M_shared > 0)
+          return;
+        _M_exclusive = true;
+      }
+      else
+      {
+        ++_M_shared;
+      }
+
+      _M_waiting_queue._Pop();
+      __ready._Push(__op);
+    }
+  }
+
+  mutex _M_mutex;
+  __op_queue<__shared_strand_op> _M_waiting_queue;
+  size_t _M_shared = 0;
+  bool _M_exclusive = false;
+};
+
+template <class _Executor> template <class _Dummy>
+inline shared_strand<_Executor>::shared_strand(_Dummy, typename enable_if<is_default_constructible<_Executor>::value, _Dummy>::type*)
+  : _M_executor(),
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__shared_strand_impl>(__small_block_allocator<void, __shared_strand_impl>()))
+{
+}
+
+template <class _Executor>
+inline shared_strand<_Executor>::shared_strand(_Executor __e)
+  : _M_executor(std::move(__e)),
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__shared_strand_impl>(__small_block_allocator<void, __shared_strand_impl>()))
+{
+}
+
+template <class _Executor> template <class _Alloc>
+inline shared_strand<_Executor>::shared_strand(allocator_arg_t, const _Alloc& __a, _Executor __e)
+  : _M_executor(std::move(__e)),
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__shared_strand_impl>(__a))
+{
+}
+
+template <class _Executor>
+inline typename shared_strand<_Executor>::inner_executor_type shared_strand<_Executor>::get_inner_executor() const noexcept
+{
+  return _M_executor;
+}
+
+template <class _Executor>
+inline typename shared_strand<_Executor>::executor_type shared_strand<_Executor>::get_shared_executor() const noexcept
+{
+  return executor_type(_M_executor, _M_impl, false);
+}
+
+template <class _Executor>
+inline typename shared_strand<_Executor>::executor_type shared_strand<_Executor>::get_exclusive_executor() const noexcept
+{
+  return executor_type(_M_executor, _M_impl, true);
+}
+
+template <class _Executor>
+inline shared_strand_executor<_Executor>::shared_strand_executor(const _Executor& __e,
+    const shared_ptr<__shared_strand_impl>& __i, bool __exclusive)
+  : _M_executor(__e), _M_impl(__i), _M_exclusive(__exclusive)
+{
+}
+
+template <class _Executor>
+inline typename shared_strand_executor<_Executor>::inner_executor_type shared_strand_executor<_Executor>::get_inner_executor() const noexcept
+{
+  return _M_executor;
+}
+
+template <class _Executor>
+inline bool shared_strand_executor<_Executor>::is_exclusive() const noexcept
+{
+  return _M_exclusive;
+}
+
+template <class _Executor>
+inline bool shared_strand_executor<_Executor>::running_in_this_thread() const noexcept
+{
+  // A thread running an exclusive operation may also act as a reader.
+  bool* __exclusive = __call_stack<__shared_strand_impl, bool>::_Contains(_M_impl.get());
+  return __exclusive && (*__exclusive || !_M_exclusive);
+}
+
+template <class _Executor>
+inline execution_context& shared_strand_executor<_Executor>::context() noexcept
+{
+  return _M_executor.context();
+}
+
+template <class _Executor>
+inline void shared_strand_executor<_Executor>::on_work_started() noexcept
+{
+  return _M_executor.on_work_started();
+}
+
+template <class _Executor>
+inline void shared_strand_executor<_Executor>::on_work_finished() noexcept
+{
+  return _M_executor.on_work_finished();
+}
+
+template <class _Func, class _Alloc>
+class __shared_strand_func_op
+  : public __shared_strand_op
+{
+public:
+  __shared_strand_func_op(const __shared_strand_func_op&) = delete;
+  __shared_strand_func_op& operator=(const __shared_strand_func_op&) = delete;
+
+  template <class _F> __shared_strand_func_op(_F&& __f, const _Alloc& __a, bool __exclusive)
+    : __shared_strand_op(__exclusive), _M_func(forward<_F>(__f)), _M_alloc(__a)
+  {
+  }
+
+  virtual void _Complete()
+  {
+    auto __op(_Adopt_small_block(_M_alloc, this));
+    _Func __tmp(std::move(_M_func));
+    __op.reset();
+    std::move(__tmp)();
+  }
+
+  virtual void _Destroy()
+  {
+    _Adopt_small_block(_M_alloc, this);
+  }
+
+private:
+  _Func _M_func;
+  _Alloc _M_alloc;
+};
+
+// Runs one started operation. When it finishes, the first operation to become
+// ready runs next on the same thread, and any others are posted so that they
+// may run in parallel.
+
+template <class _Executor>
+struct __shared_strand_invoker
+{
+  executor_work<_Executor> _M_work;
+  shared_ptr<__shared_strand_impl> _M_impl;
+  __shared_strand_op* _M_op;
+
+  __shared_strand_invoker(const _Executor& __e,
+      const shared_ptr<__shared_strand_impl>& __i, __shared_strand_op* __op)
+    : _M_work(__e), _M_impl(__i), _M_op(__op)
+  {
+  }
+
+  __shared_strand_invoker(__shared_strand_invoker&& __i)
+    : _M_work(std::move(__i._M_work)), _M_impl(std::move(__i._M_impl)), _M_op(__i._M_op)
+  {
+    __i._M_op = nullptr;
+  }
+
+  ~__shared_strand_invoker()
+  {
+    if (_M_op)
+      _M_op->_Destroy();
+  }
+
+  static void _Post(const _Executor& __e, const shared_ptr<__shared_strand_impl>& __i,
+      __op_queue<__shared_strand_op>& __ops)
+  {
+    while (__shared_strand_op* __op = __ops._Front())
+    {
+      __ops._Pop();
+      _Executor(__e).post(__shared_strand_invoker(__e, __i, __op),
+        __small_block_allocator<void, __shared_strand_impl>());
+    }
+  }
+
+  struct _On_exit
+  {
+    __shared_strand_invoker* _M_invoker;
+    bool _M_exclusive;
+    bool _M_completed;
+
+    ~_On_exit()
+    {
+      __op_queue<__shared_strand_op> __ready;
+      _M_invoker->_M_impl->_Finish(_M_exclusive, __ready);
+
+      // If the operation exited by exception the invoker is done, and all of
+      // the ready operations must be posted.
+      if (_M_completed && (_M_invoker->_M_op = __ready._Front()) != nullptr)
+        __ready._Pop();
+      _Post(_M_invoker->_M_work.get_executor(), _M_invoker->_M_impl, __ready);
+    }
+  };
+
+  void operator()()
+  {
+    while (__shared_strand_op* __op = _M_op)
+    {
+      _M_op = nullptr;
+      _On_exit __on_exit{this, __op->_M_exclusive, false};
+      __call_stack<__shared_strand_impl, bool>::__context __ctx(_M_impl.get(), __on_exit._M_exclusive);
+      __op->_Complete();
+      __on_exit._M_completed = true;
+    }
+  }
+};
+
+template <class _Executor> template <class _Func, class _Alloc>
+void shared_strand_executor<_Executor>::dispatch(_Func&& __f, const _Alloc& __a)
+{
+  typedef typename decay<_Func>::type _DecayFunc;
+  if (running_in_this_thread())
+  {
+    _DecayFunc(forward<_Func>(__f))();
+    return;
+  }
+
+  auto __op(_Allocate_small_block<__shared_strand_func_op<_DecayFunc, _Alloc>>(__a, forward<_Func>(__f), __a, _M_exclusive));
+
+  if (__shared_strand_op* __ready = _M_impl->_Enqueue(__op.release()))
+    _M_executor.dispatch(__shared_strand_invoker<_Executor>(_M_executor, _M_impl, __ready), __small_block_allocator<void, __shared_strand_impl>());
+}
+
+template <class _Executor> template <class _Func, class _Alloc>
+void shared_strand_executor<_Executor>::post(_Func&& __f, const _Alloc& __a)
+{
+  typedef typename decay<_Func>::type _DecayFunc;
+  auto __op(_Allocate_small_block<__shared_strand_func_op<_DecayFunc, _Alloc>>(__a, forward<_Func>(__f), __a, _M_exclusive));
+
+  if (__shared_strand_op* __ready = _M_impl->_Enqueue(__op.release()))
+    _M_executor.post(__shared_strand_invoker<_Executor>(_M_executor, _M_impl, __ready), __small_block_allocator<void, __shared_strand_impl>());
+}
+
+template <class _Executor> template <class _Func, class _Alloc>
+void shared_strand_executor<_Executor>::defer(_Func&& __f, const _Alloc& __a)
+{
+  typedef typename decay<_Func>::type _DecayFunc;
+  auto __op(_Allocate_small_block<__shared_strand_func_op<_DecayFunc, _Alloc>>(__a, forward<_Func>(__f), __a, _M_exclusive));
+
+  if (__shared_strand_op* __ready = _M_impl->_Enqueue(__op.release()))
+    _M_executor.defer(__shared_strand_invoker<_Executor>(_M_executor, _M_impl, __ready), __small_block_allocator<void, __shared_strand_impl>());
+}
+
+template <class _Executor>
+inline bool operator==(const shared_strand_executor<_Executor>& __a,
+  const shared_strand_executor<_Executor>& __b) noexcept
+{
+  return __a._M_impl == __b._M_impl && __a._M_exclusive == __b._M_exclusive;
+}
+
+template <class _Executor>
+inline bool operator!=(const shared_strand_executor<_Executor>& __a,
+  const shared_strand_executor<_Executor>& __b) noexcept
+{
+  return !(__a == __b);
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
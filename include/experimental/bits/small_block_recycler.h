@@ -12,14 +12,30 @@
 #ifndef EXECUTORS_EXPERIMENTAL_BITS_SMALL_BLOCK_RECYCLER_H
 #define EXECUTORS_EXPERIMENTAL_BITS_SMALL_BLOCK_RECYCLER_H
 
-#include <climits>
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <utility>
 
 namespace std {
 namespace experimental {
 inline namespace concurrency_v1 {
 
+// Each thread caches freed blocks in a free list per size class. A thread's
+// list is bounded, and when it fills up half of it is moved to a pool shared
+// by all threads, from which a thread with an empty list takes a batch before
+// resorting to operator new. Blocks larger than the largest size class are not
+// cached.
+//
+// A cached block records the cache of the thread that allocated it. When it is
+// freed on another thread it is pushed onto that cache's lock-free return
+// list, and the owner reclaims the whole list the next time one of its free
+// lists runs dry. Caches are never destroyed: the cache of a thread that exits
+// is retired to the shared pool, where remote frees may still reach it, and is
+// adopted by the next thread that needs one.
+
 template <class _Purpose = void>
 class __small_block_recycler
 {
@@ -27,113 +43,264 @@ public:
   __small_block_recycler(const __small_block_recycler&) = delete;
   __small_block_recycler& operator=(const __small_block_recycler&) = delete;
 
-  __small_block_recycler() : _M_memory(nullptr), _M_next_memory(nullptr)
+  void* _Allocate(size_t __size)
   {
+    const size_t __c = _Class(__size);
+    if (__c == _S_num_classes)
+      return ::operator new(__size);
+
+    _Free_list& __list = _M_lists[__c];
+    if (!__list._M_head)
+      _Reclaim();
+    if (!__list._M_head)
+      _Pool()._Take(__c, __list, _S_batch_size);
+
+    _Header* __h = __list._M_head;
+    if (__h)
+    {
+      __list._M_head = _Next(__h);
+      --__list._M_count;
+    }
+    else
+    {
+      __h = static_cast<_Header*>(::operator new(sizeof(_Header) + (_S_min_size << __c)));
+      __h->_M_class = __c;
+    }
+
+    __h->_M_owner = this;
+    return __h + 1;
   }
 
-// The clang compiler shipped with Xcode doesn't support the thread_local
-// keyword. We make do with the __thread keyword extension, but this means we
-// cannot have a non-trivial destructor.
-#if !defined(__APPLE__) || !defined(__clang__)
-  ~__small_block_recycler()
+  void _Deallocate(void* __p, size_t __size)
   {
-    if (_M_memory)
-      ::operator delete(_M_memory);
-    if (_M_next_memory)
-      ::operator delete(_M_next_memory);
+    if (__p)
+    {
+      const size_t __c = _Class(__size);
+      if (__c == _S_num_classes)
+      {
+        ::operator delete(__p);
+        return;
+      }
+
+      _Header* __h = static_cast<_Header*>(__p) - 1;
+      if (__h->_M_owner == this)
+        _Push_local(__h);
+      else
+        __h->_M_owner->_Push_remote(__h);
+    }
   }
+
+  static __small_block_recycler& _Instance()
+  {
+#if defined(__APPLE__) && defined(__clang__) || defined(_MSC_VER)
+    if (!_S_instance)
+      _S_instance = _Pool()._Adopt();
+    return *_S_instance;
+#else
+    static thread_local _Owner __owner;
+    if (!__owner._M_instance)
+      __owner._M_instance = _Pool()._Adopt();
+    return *__owner._M_instance;
 #endif
+  }
 
-  void* _Allocate(size_t __size)
+private:
+  // Size classes are powers of two from _S_min_size up to 1024 bytes.
+  static constexpr size_t _S_min_size = 16;
+  static constexpr size_t _S_num_classes = 7;
+
+  // The most blocks of one size class that a thread may hold, the number moved
+  // to or from the shared pool at a time, and the most the pool may hold.
+  static constexpr size_t _S_thread_limit = 32;
+  static constexpr size_t _S_batch_size = _S_thread_limit / 2;
+  static constexpr size_t _S_pool_limit = 1024;
+
+  // Precedes the memory handed out for a cached block.
+  struct alignas(max_align_t) _Header
   {
-    if (_M_memory)
-    {
-      void* const __p = _M_memory;
-      _M_memory = _M_next_memory;
-      _M_next_memory = nullptr;
+    __small_block_recycler* _M_owner;
+    size_t _M_class;
+  };
 
-      unsigned char* const __mem = static_cast<unsigned char*>(__p);
-      if (static_cast<size_t>(__mem[0]) >= __size)
-      {
-        __mem[__size] = __mem[0];
-        return __p;
-      }
+  // While a block is free, its memory links it into a list.
+  static _Header*& _Next(_Header* __h) noexcept
+  {
+    return *reinterpret_cast<_Header**>(__h + 1);
+  }
+
+  struct _Free_list
+  {
+    _Header* _M_head;
+    size_t _M_count;
+  };
+
+  __small_block_recycler() : _M_lists(), _M_returned(nullptr), _M_next_retired(nullptr)
+  {
+  }
+
+  // Returns _S_num_classes if the size is too large to be cached.
+  static size_t _Class(size_t __size) noexcept
+  {
+    size_t __c = 0;
+    while (__c < _S_num_classes && (_S_min_size << __c) < __size)
+      ++__c;
+    return __c;
+  }
 
-      ::operator delete(__p);
+  // Move up to __n blocks from the front of one free list to another.
+  static void _Splice(_Free_list& __from, _Free_list& __to, size_t __n) noexcept
+  {
+    for (; __n > 0 && __from._M_head; --__n)
+    {
+      _Header* __h = __from._M_head;
+      __from._M_head = _Next(__h);
+      --__from._M_count;
+      _Next(__h) = __to._M_head;
+      __to._M_head = __h;
+      ++__to._M_count;
     }
+  }
+
+  void _Push_local(_Header* __h)
+  {
+    _Free_list& __list = _M_lists[__h->_M_class];
+    if (__list._M_count == _S_thread_limit)
+      _Pool()._Give(__h->_M_class, __list, _S_batch_size);
 
-    void* const __p = ::operator new(__size + 1);
-    unsigned char* const __mem = static_cast<unsigned char*>(__p);
-    __mem[__size] = (__size <= UCHAR_MAX) ? static_cast<unsigned char>(__size) : 0;
-    return __p;
+    _Next(__h) = __list._M_head;
+    __list._M_head = __h;
+    ++__list._M_count;
   }
 
-  void _Deallocate(void* __p, size_t __size)
+  // Called by a thread other than the owner.
+  void _Push_remote(_Header* __h) noexcept
   {
-    if (__p)
+    _Next(__h) = _M_returned.load(memory_order_relaxed);
+    while (!_M_returned.compare_exchange_weak(_Next(__h), __h,
+          memory_order_release, memory_order_relaxed))
+      ;
+  }
+
+  // Take back all blocks freed by other threads since the last call.
+  void _Reclaim()
+  {
+    if (!_M_returned.load(memory_order_relaxed))
+      return;
+
+    _Header* __h = _M_returned.exchange(nullptr, memory_order_acquire);
+    while (__h)
+    {
+      _Header* __next = _Next(__h);
+      _Push_local(__h);
+      __h = __next;
+    }
+  }
+
+  class _Shared_pool
+  {
+  public:
+    _Shared_pool() : _M_lists(), _M_retired(nullptr) {}
+
+    void _Take(size_t __c, _Free_list& __list, size_t __n)
+    {
+      lock_guard<mutex> __lock(_M_mutex);
+      _Splice(_M_lists[__c], __list, __n);
+    }
+
+    void _Give(size_t __c, _Free_list& __list, size_t __n)
     {
-      if (__size <= UCHAR_MAX)
       {
-        if (_M_memory == 0)
-        {
-          unsigned char* const __mem = static_cast<unsigned char*>(__p);
-          __mem[0] = __mem[__size];
-          _M_memory = __p;
-          return;
-        }
+        lock_guard<mutex> __lock(_M_mutex);
+        size_t __room = _S_pool_limit - _M_lists[__c]._M_count;
+        _Splice(__list, _M_lists[__c], __n < __room ? __n : __room);
+        __n = __n < __room ? 0 : __n - __room;
+      }
+
+      for (; __n > 0 && __list._M_head; --__n)
+      {
+        _Header* __h = __list._M_head;
+        __list._M_head = _Next(__h);
+        --__list._M_count;
+        ::operator delete(__h);
+      }
+    }
 
-        if (_M_next_memory == 0)
+    __small_block_recycler* _Adopt()
+    {
+      {
+        lock_guard<mutex> __lock(_M_mutex);
+        if (__small_block_recycler* __r = _M_retired)
         {
-          unsigned char* const __mem = static_cast<unsigned char*>(__p);
-          __mem[0] = __mem[__size];
-          _M_next_memory = __p;
-          return;
+          _M_retired = __r->_M_next_retired;
+          __r->_M_next_retired = nullptr;
+          return __r;
         }
       }
 
-      ::operator delete(__p);
+      return new __small_block_recycler;
     }
-  }
 
-  static __small_block_recycler& _Instance()
+    void _Retire(__small_block_recycler* __r)
+    {
+      for (size_t __c = 0; __c < _S_num_classes; ++__c)
+        _Give(__c, __r->_M_lists[__c], __r->_M_lists[__c]._M_count);
+
+      lock_guard<mutex> __lock(_M_mutex);
+      __r->_M_next_retired = _M_retired;
+      _M_retired = __r;
+    }
+
+  private:
+    mutex _M_mutex;
+    _Free_list _M_lists[_S_num_classes];
+    __small_block_recycler* _M_retired;
+  };
+
+  // The shared pool is never destroyed, so that threads which outlive static
+  // destruction may still return their blocks to it.
+  static _Shared_pool& _Pool()
   {
-#if defined(__APPLE__) && defined(__clang__)
-    return _S_instance;
-#elif defined(_MSC_VER) || defined(__GNUC__)
-    if (!_S_instance)
-      _S_instance = new __small_block_recycler;
-    return *_S_instance;
-#else
-    return _S_instance;
-#endif
+    static _Shared_pool* __pool = new _Shared_pool;
+    return *__pool;
   }
 
-private:
-  void* _M_memory;
-  void* _M_next_memory;
+  _Free_list _M_lists[_S_num_classes];
+  atomic<_Header*> _M_returned;
+  __small_block_recycler* _M_next_retired;
+
+// The clang compiler shipped with Xcode doesn't support the thread_local
+// keyword. We make do with the __thread keyword extension, but this means we
+// cannot have a non-trivial destructor, and a thread's cache is not retired
+// when the thread exits.
 #if defined(__APPLE__) && defined(__clang__)
-  static __thread __small_block_recycler _S_instance;
+  static __thread __small_block_recycler* _S_instance;
 #elif defined(_MSC_VER)
   static __declspec(thread) __small_block_recycler* _S_instance;
-#elif defined(__GNUC__)
-  static thread_local __small_block_recycler* _S_instance;
 #else
-  static thread_local __small_block_recycler _S_instance;
+  // Retires the thread's cache when the thread exits. It is held in a
+  // function-local static, as GCC cannot define thread_local static data
+  // members with non-trivial destructors for more than one class template in
+  // a translation unit.
+  struct _Owner
+  {
+    __small_block_recycler* _M_instance;
+
+    ~_Owner()
+    {
+      if (_M_instance)
+        _Pool()._Retire(_M_instance);
+      _M_instance = nullptr;
+    }
+  };
 #endif
 };
 
 #if defined(__APPLE__) && defined(__clang__)
 template <class _Purpose>
-__thread __small_block_recycler<_Purpose> __small_block_recycler<_Purpose>::_S_instance;
+__thread __small_block_recycler<_Purpose>* __small_block_recycler<_Purpose>::_S_instance;
 #elif defined(_MSC_VER)
 template <class _Purpose>
 __declspec(thread) __small_block_recycler<_Purpose>* __small_block_recycler<_Purpose>::_S_instance;
-#elif defined(__GNUC__)
-template <class _Purpose>
-thread_local __small_block_recycler<_Purpose>* __small_block_recycler<_Purpose>::_S_instance;
-#else
-template <class _Purpose>
-thread_local __small_block_recycler<_Purpose> __small_block_recycler<_Purpose>::_S_instance;
 #endif
 
 template <class _T, class _Purpose = void>
@@ -17,7 +17,9 @@
 #include <experimental/type_traits>
 #include <experimental/bits/call_stack.h>
 #include <experimental/bits/operation.h>
+#include <experimental/bits/scheduler_statistics.h>
 #include <experimental/bits/small_block_recycler.h>
+#include <experimental/bits/worker_affinity.h>
 
 namespace std {
 namespace experimental {
@@ -25,52 +27,115 @@ inline namespace concurrency_v1 {
 
 class __strand_service;
 
-struct __strand_impl
+// Each strand implementation is registered with its execution context's
+// service, so that the operations it holds can be destroyed on shutdown. An
+// implementation registers once it is fully constructed, and unregisters
+// before any of its members are destroyed.
+
+class __strand_node
 {
-  explicit __strand_impl(__strand_service& __s);
-  __strand_impl(const __strand_impl&) = delete;
-  __strand_impl& operator=(const __strand_impl&) = delete;
-  ~__strand_impl();
+public:
+  // Move every operation held by the implementation to __ops.
+  virtual void _Shutdown(__op_queue<__operation>& __ops) = 0;
 
-#if defined(_MSC_VER)
-  atomic_flag _M_lock;
-#else
-  atomic_flag _M_lock = ATOMIC_FLAG_INIT;
-#endif
-  bool _M_ready = false;
-  __op_queue<__operation> _M_waiting_queue;
-  __op_queue<__operation> _M_ready_queue;
+protected:
+  __strand_node() = default;
+  __strand_node(const __strand_node&) = delete;
+  __strand_node& operator=(const __strand_node&) = delete;
+  ~__strand_node() = default;
+
+  void _Register(__strand_service& __s);
+  void _Unregister();
+
+private:
+  friend class __strand_service;
   __strand_service* _M_service = nullptr;
-  __strand_impl* _M_prev = nullptr;
-  __strand_impl* _M_next = nullptr;
+  size_t _M_bucket = 0;
+  __strand_node* _M_prev = nullptr;
+  __strand_node* _M_next = nullptr;
+};
+
+// Operations submitted to a strand are pushed onto a lock-free queue. The
+// submitter that finds the strand idle marks it scheduled and submits the
+// invoker, which takes all queued operations at once and runs them. When the
+// invoker finishes it marks the strand idle and then looks at the queue again,
+// rescheduling itself if it finds more work and no submitter has done so.
 
-  class _Lock_guard
+struct __strand_impl final
+  : __strand_node
+{
+  explicit __strand_impl(__strand_service& __s,
+      const strand_options& __options = strand_options())
+    : _M_max_operations(__options.max_operations), _M_max_time(__options.max_time)
   {
-  public:
-    _Lock_guard(const _Lock_guard&) = delete;
-    _Lock_guard& operator=(const _Lock_guard&) = delete;
+    _Register(__s);
+  }
 
-    explicit _Lock_guard(__strand_impl& __i) : _M_lock(__i._M_lock)
-    {
-      while (_M_lock.test_and_set(memory_order_acquire)) {}
-    }
+  ~__strand_impl()
+  {
+    _Unregister();
+  }
 
-    ~_Lock_guard()
-    {
-      _M_lock.clear(memory_order_release);
-    }
+  // Push an operation, returning true if the caller must schedule the invoker.
+  bool _Enqueue(__operation* __op)
+  {
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+    __op->_M_enqueue_time = chrono::steady_clock::now();
+#endif
+    _M_waiting_queue._Push(__op);
+    return !_M_scheduled.load() && !_M_scheduled.exchange(true);
+  }
+
+  // Called by the invoker when it is done, returning true if it must run again.
+  bool _Reschedule()
+  {
+    _M_scheduled.store(false);
+    return !_M_waiting_queue._Empty() && !_M_scheduled.exchange(true);
+  }
 
-  private:
-    atomic_flag& _M_lock;
+  void _Shutdown(__op_queue<__operation>& __ops)
+  {
+    __ops._Push(_M_ready_queue);
+    _M_waiting_queue._Pop_all(__ops);
+  }
+
+  atomic<bool> _M_scheduled{false};
+  __worker_affinity _M_affinity;
+  __op_mpsc_queue<__operation> _M_waiting_queue;
+  __op_queue<__operation> _M_ready_queue;
+  const size_t _M_max_operations;
+  const chrono::steady_clock::duration _M_max_time;
+
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+  // Updated only by the invoker, but may be read by any thread.
+  struct _Statistics
+  {
+    atomic<uint64_t> _M_executed{0};
+    atomic<uint64_t> _M_invocations{0};
+    atomic<uint64_t> _M_reschedules{0};
+    atomic<uint64_t> _M_limit_reached{0};
+    atomic<uint64_t> _M_waiting_total{0};
+    atomic<size_t> _M_max_waiting{0};
+    __atomic_histogram _M_enqueue_to_start;
   };
+
+  _Statistics _M_statistics;
+#endif
 };
 
+// The service keeps every live implementation so that their operations can be
+// destroyed on shutdown. Implementations are spread over several lists, each
+// with its own mutex, so that strands created and destroyed on different
+// threads do not contend with one another.
+
 class __strand_service
   : public execution_context::service
 {
 public:
+  static constexpr size_t _S_num_buckets = 16;
+
   __strand_service(execution_context& __c)
-    : execution_context::service(__c), _M_first(nullptr)
+    : execution_context::service(__c), _M_next_bucket(0)
   {
   }
 
@@ -81,44 +146,56 @@ public:
   void shutdown_service()
   {
     __op_queue<__operation> __ops;
-    lock_guard<mutex> __lock(_M_mutex);
 
-    for (__strand_impl* __i = _M_first; __i; __i = __i->_M_next)
+    for (_Bucket& __b: _M_buckets)
     {
-      __strand_impl::_Lock_guard __strand_lock(*__i);
-      __ops._Push(__i->_M_waiting_queue);
-      __ops._Push(__i->_M_ready_queue);
+      lock_guard<mutex> __lock(__b._M_mutex);
+
+      for (__strand_node* __n = __b._M_first; __n; __n = __n->_M_next)
+        __n->_Shutdown(__ops);
     }
   }
 
+  template <class _Impl, class _Alloc, class... _Args>
+  shared_ptr<_Impl> _Create(const _Alloc& __a, _Args&&... __args)
+  {
+    return allocate_shared<_Impl>(__a, *this, forward<_Args>(__args)...);
+  }
+
 private:
-  template <class> friend class strand;
-  friend struct __strand_impl;
-  mutable mutex _M_mutex;
-  __strand_impl* _M_first;
+  friend class __strand_node;
+
+  struct _Bucket
+  {
+    mutex _M_mutex;
+    __strand_node* _M_first = nullptr;
+  };
+
+  _Bucket _M_buckets[_S_num_buckets];
+  atomic<size_t> _M_next_bucket;
 };
 
-inline __strand_impl::__strand_impl(__strand_service& __s)
-  : _M_service(&__s)
+inline void __strand_node::_Register(__strand_service& __s)
 {
-#if defined(_MSC_VER)
-  _M_lock.clear();
-#endif
+  _M_service = &__s;
+  _M_bucket = __s._M_next_bucket.fetch_add(1, memory_order_relaxed) % __strand_service::_S_num_buckets;
 
-  lock_guard<mutex> __lock(_M_service->_M_mutex);
+  __strand_service::_Bucket& __b = _M_service->_M_buckets[_M_bucket];
+  lock_guard<mutex> __lock(__b._M_mutex);
 
-  _M_next = _M_service->_M_first;
-  if (_M_service->_M_first)
-    _M_service->_M_first->_M_prev = this;
-  _M_service->_M_first = this;
+  _M_next = __b._M_first;
+  if (__b._M_first)
+    __b._M_first->_M_prev = this;
+  __b._M_first = this;
 }
 
-inline __strand_impl::~__strand_impl()
+inline void __strand_node::_Unregister()
 {
-  lock_guard<mutex> __lock(_M_service->_M_mutex);
+  __strand_service::_Bucket& __b = _M_service->_M_buckets[_M_bucket];
+  lock_guard<mutex> __lock(__b._M_mutex);
 
-  if (_M_service->_M_first == this)
-    _M_service->_M_first = _M_next;
+  if (__b._M_first == this)
+    __b._M_first = _M_next;
   if (_M_prev)
     _M_prev->_M_next = _M_next;
   if (_M_next)
@@ -128,14 +205,36 @@ inline __strand_impl::~__strand_impl()
 template <class _Executor> template <class _Dummy>
 inline strand<_Executor>::strand(_Dummy, typename enable_if<is_default_constructible<_Executor>::value, _Dummy>::type*)
   : _M_executor(),
-    _M_impl(make_shared<__strand_impl>(use_service<__strand_service>(_M_executor.context())))
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__strand_impl>(__small_block_allocator<void, __strand_impl>()))
 {
 }
 
 template <class _Executor>
 inline strand<_Executor>::strand(_Executor __e)
   : _M_executor(std::move(__e)),
-    _M_impl(make_shared<__strand_impl>(use_service<__strand_service>(_M_executor.context())))
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__strand_impl>(__small_block_allocator<void, __strand_impl>()))
+{
+}
+
+template <class _Executor>
+inline strand<_Executor>::strand(_Executor __e, const strand_options& __options)
+  : _M_executor(std::move(__e)),
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__strand_impl>(__small_block_allocator<void, __strand_impl>(), __options))
+{
+}
+
+template <class _Executor> template <class _Alloc>
+inline strand<_Executor>::strand(allocator_arg_t, const _Alloc& __a, _Executor __e)
+  : _M_executor(std::move(__e)),
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__strand_impl>(__a))
+{
+}
+
+template <class _Executor> template <class _Alloc>
+inline strand<_Executor>::strand(allocator_arg_t, const _Alloc& __a, _Executor __e,
+    const strand_options& __options)
+  : _M_executor(std::move(__e)),
+    _M_impl(use_service<__strand_service>(_M_executor.context()).template _Create<__strand_impl>(__a, __options))
 {
 }
 
@@ -289,15 +388,15 @@ struct __strand_invoker
 
     ~_On_exit()
     {
-      bool __more;
-      {
-        __strand_impl::_Lock_guard __lock(*_M_invoker->_M_impl);
-        _M_invoker->_M_impl->_M_ready_queue._Push(_M_invoker->_M_impl->_M_waiting_queue);
-        __more = _M_invoker->_M_impl->_M_ready = !_M_invoker->_M_impl->_M_ready_queue._Empty();
-      }
-
-      if (__more)
+      // Operations left in the ready queue, because one of them exited by
+      // exception, are run ahead of any that are still waiting.
+      // So are operations left because the invoker reached a limit.
+      if (!_M_invoker->_M_impl->_M_ready_queue._Empty()
+          || _M_invoker->_M_impl->_Reschedule())
       {
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+        _M_invoker->_M_impl->_M_statistics._M_reschedules.fetch_add(1, memory_order_relaxed);
+#endif
         auto __executor(_M_invoker->_M_work.get_executor());
         __executor.defer(std::move(*_M_invoker), __small_block_allocator<void, __strand_impl>());
       }
@@ -307,18 +406,56 @@ struct __strand_invoker
   void operator()()
   {
     __call_stack<__strand_impl>::__context __ctx(_M_impl.get());
+    _M_impl->_M_affinity._Record();
 
     _On_exit __on_exit{this};
     (void)__on_exit;
 
-    while (__operation* __op = _M_impl->_M_ready_queue._Front())
+    size_t __waiting = _M_impl->_M_waiting_queue._Pop_all(_M_impl->_M_ready_queue);
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+    __strand_impl::_Statistics& __stats = _M_impl->_M_statistics;
+    __stats._M_invocations.fetch_add(1, memory_order_relaxed);
+    __stats._M_waiting_total.fetch_add(__waiting, memory_order_relaxed);
+    if (__waiting > __stats._M_max_waiting.load(memory_order_relaxed))
+      __stats._M_max_waiting.store(__waiting, memory_order_relaxed);
+#else
+    (void)__waiting;
+#endif
+
+    const size_t __max_operations = _M_impl->_M_max_operations;
+    const chrono::steady_clock::duration __max_time = _M_impl->_M_max_time;
+    chrono::steady_clock::time_point __deadline;
+    if (__max_time != chrono::steady_clock::duration::zero())
+      __deadline = chrono::steady_clock::now() + __max_time;
+
+    for (size_t __n = 0; __operation* __op = _M_impl->_M_ready_queue._Front(); ++__n)
     {
+      if (__n > 0 && ((__max_operations > 0 && __n >= __max_operations)
+            || (__max_time != chrono::steady_clock::duration::zero()
+              && chrono::steady_clock::now() >= __deadline)))
+      {
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+        __stats._M_limit_reached.fetch_add(1, memory_order_relaxed);
+#endif
+        return;
+      }
+
       _M_impl->_M_ready_queue._Pop();
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+      __stats._M_executed.fetch_add(1, memory_order_relaxed);
+      __stats._M_enqueue_to_start._Record(chrono::steady_clock::now() - __op->_M_enqueue_time);
+#endif
       __op->_Complete();
     }
   }
 };
 
+template <class _Executor>
+inline const __worker_affinity* __affinity_of(const __strand_invoker<_Executor>& __i) noexcept
+{
+  return &__i._M_impl->_M_affinity;
+}
+
 template <class _Executor> template <class _Func, class _Alloc>
 void strand<_Executor>::dispatch(_Func&& __f, const _Alloc& __a)
 {
@@ -332,21 +469,8 @@ void strand<_Executor>::dispatch(_Func&& __f, const _Alloc& __a)
   typedef typename decay<_Func>::type _DecayFunc;
   auto __op(_Allocate_small_block<__strand_op<_DecayFunc, _Alloc>>(__a, forward<_Func>(__f), __a));
 
-  {
-    __strand_impl::_Lock_guard __lock(*_M_impl);
-
-    if (_M_impl->_M_ready)
-    {
-      _M_impl->_M_waiting_queue._Push(__op.get());
-      __op.release();
-      return;
-    }
-
-    _M_impl->_M_ready = true;
-  }
-
-  _M_impl->_M_ready_queue._Push(__op.get());
-  __op.release();
+  if (!_M_impl->_Enqueue(__op.release()))
+    return;
 
   _M_executor.dispatch(__strand_invoker<_Executor>(_M_executor, _M_impl), __small_block_allocator<void, __strand_impl>());
 }
@@ -357,21 +481,8 @@ void strand<_Executor>::post(_Func&& __f, const _Alloc& __a)
   typedef typename decay<_Func>::type _DecayFunc;
   auto __op(_Allocate_small_block<__strand_op<_DecayFunc, _Alloc>>(__a, forward<_Func>(__f), __a));
 
-  {
-    __strand_impl::_Lock_guard __lock(*_M_impl);
-
-    if (_M_impl->_M_ready)
-    {
-      _M_impl->_M_waiting_queue._Push(__op.get());
-      __op.release();
-      return;
-    }
-
-    _M_impl->_M_ready = true;
-  }
-
-  _M_impl->_M_ready_queue._Push(__op.get());
-  __op.release();
+  if (!_M_impl->_Enqueue(__op.release()))
+    return;
 
   _M_executor.post(__strand_invoker<_Executor>{_M_executor, _M_impl}, __small_block_allocator<void, __strand_impl>());
 }
@@ -382,25 +493,30 @@ inline void strand<_Executor>::defer(_Func&& __f, const _Alloc& __a)
   typedef typename decay<_Func>::type _DecayFunc;
   auto __op(_Allocate_small_block<__strand_op<_DecayFunc, _Alloc>>(__a, forward<_Func>(__f), __a));
 
-  {
-    __strand_impl::_Lock_guard __lock(*_M_impl);
-
-    if (_M_impl->_M_ready)
-    {
-      _M_impl->_M_waiting_queue._Push(__op.get());
-      __op.release();
-      return;
-    }
-
-    _M_impl->_M_ready = true;
-  }
-
-  _M_impl->_M_ready_queue._Push(__op.get());
-  __op.release();
+  if (!_M_impl->_Enqueue(__op.release()))
+    return;
 
   _M_executor.defer(__strand_invoker<_Executor>{_M_executor, _M_impl}, __small_block_allocator<void, __strand_impl>());
 }
 
+template <class _Executor>
+strand_statistics strand<_Executor>::statistics() const
+{
+  strand_statistics __stats;
+#if defined(EXECUTORS_ENABLE_STATISTICS)
+  const __strand_impl::_Statistics& __s = _M_impl->_M_statistics;
+  __stats.operations_executed = __s._M_executed.load(memory_order_relaxed);
+  __stats.invocations = __s._M_invocations.load(memory_order_relaxed);
+  __stats.reschedules = __s._M_reschedules.load(memory_order_relaxed);
+  __stats.limit_reached = __s._M_limit_reached.load(memory_order_relaxed);
+  __stats.max_waiting = __s._M_max_waiting.load(memory_order_relaxed);
+  if (__stats.invocations > 0)
+    __stats.average_waiting = static_cast<double>(__s._M_waiting_total.load(memory_order_relaxed)) / __stats.invocations;
+  __s._M_enqueue_to_start._Read(__stats.enqueue_to_start);
+#endif
+  return __stats;
+}
+
 template <class _Executor>
 inline bool operator==(const strand<_Executor>& __a, const strand<_Executor>& __b) noexcept
 {
@@ -418,6 +534,48 @@ template <class _T> inline auto make_strand(_T&& __t)
   return strand<typename decay<_T>::type>(forward<_T>(__t));
 }
 
+template <class _Executor>
+strand_pool<_Executor>::strand_pool(_Executor __e, size_t __n, const strand_options& __options)
+  : strand_pool(allocator_arg, __small_block_allocator<void, __strand_impl>(), std::move(__e), __n, __options)
+{
+}
+
+template <class _Executor> template <class _Alloc>
+strand_pool<_Executor>::strand_pool(allocator_arg_t, const _Alloc& __a, _Executor __e,
+    size_t __n, const strand_options& __options)
+  : _M_executor(std::move(__e))
+{
+  __strand_service& __s = use_service<__strand_service>(_M_executor.context());
+  size_t __count = __n ? __n : 1;
+  _M_impls.reserve(__count);
+  for (size_t __i = 0; __i < __count; ++__i)
+    _M_impls.push_back(__s._Create<__strand_impl>(__a, __options));
+}
+
+template <class _Executor>
+inline typename strand_pool<_Executor>::inner_executor_type strand_pool<_Executor>::get_inner_executor() const noexcept
+{
+  return _M_executor;
+}
+
+template <class _Executor>
+inline size_t strand_pool<_Executor>::size() const noexcept
+{
+  return _M_impls.size();
+}
+
+template <class _Executor>
+inline typename strand_pool<_Executor>::strand_type strand_pool<_Executor>::get_strand(size_t __i) const
+{
+  return strand_type(_M_executor, _M_impls[__i % _M_impls.size()]);
+}
+
+template <class _Executor> template <class _Key>
+inline typename strand_pool<_Executor>::strand_type strand_pool<_Executor>::get_strand_for(const _Key& __k) const
+{
+  return get_strand(hash<_Key>()(__k));
+}
+
 } // inline namespace concurrency_v1
 } // namespace experimental
 } // namespace std
@@ -79,6 +79,21 @@ public:
     _M_scheduler._Defer(forward<_F>(__f), __a);
   }
 
+  template <class _Iter, class _A> void _Post_range(_Iter __first, _Iter __last, const _A& __a)
+  {
+    _M_scheduler._Post_range(__first, __last, __a);
+  }
+
+  template <class _A, class... _F> void _Post_each(const _A& __a, _F&&... __f)
+  {
+    _M_scheduler._Post_each(__a, forward<_F>(__f)...);
+  }
+
+  scheduler_statistics _Statistics() const
+  {
+    return _M_scheduler._Statistics();
+  }
+
 private:
   __scheduler _M_scheduler;
   vector<thread> _M_threads;
@@ -121,6 +136,23 @@ inline void system_executor::defer(_Func&& __f, const _Alloc& __a)
   __system_executor_impl::_Instance()._Defer(forward<_Func>(__f), __a);
 }
 
+template <class _InputIterator, class _Alloc>
+inline void system_executor::post_range(_InputIterator __first, _InputIterator __last, const _Alloc& __a)
+{
+  __system_executor_impl::_Instance()._Post_range(__first, __last, __a);
+}
+
+template <class _Alloc, class... _Funcs>
+inline void system_executor::post_each(const _Alloc& __a, _Funcs&&... __fs)
+{
+  __system_executor_impl::_Instance()._Post_each(__a, forward<_Funcs>(__fs)...);
+}
+
+inline scheduler_statistics system_executor::statistics() const
+{
+  return __system_executor_impl::_Instance()._Statistics();
+}
+
 inline bool operator==(const system_executor&, const system_executor&) noexcept
 {
   return true;
@@ -12,6 +12,7 @@
 #ifndef EXECUTORS_EXPERIMENTAL_BITS_THREAD_POOL_H
 #define EXECUTORS_EXPERIMENTAL_BITS_THREAD_POOL_H
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace std {
@@ -24,13 +25,27 @@ inline thread_pool::thread_pool()
 }
 
 inline thread_pool::thread_pool(size_t __num_threads)
-  : __scheduler(__num_threads)
+  : thread_pool(__num_threads, scheduler_options())
 {
+}
+
+inline thread_pool::thread_pool(size_t __num_threads,
+    const scheduler_options& __options)
+  : __scheduler(__options.max_threads > __num_threads
+      ? __options.max_threads : __num_threads, _Scheduler_options(__options)),
+    _M_options(__options),
+    _M_elastic(__num_threads > 0 && __options.max_threads > __num_threads),
+    _M_min_threads(__num_threads), _M_num_threads(0), _M_joining(false)
+{
+  if (__options.run_timers)
+    _Set_timers(make_service<__reactor>(*this, static_cast<__reactor_host&>(*this)));
+
   if (__num_threads > 0)
   {
     _Work_started();
+    lock_guard<mutex> __lock(_M_threads_mutex);
     for (size_t __i = 0; __i < __num_threads; ++__i)
-      _M_threads.emplace_back([this](){ _Run(); });
+      _Start_thread();
   }
 }
 
@@ -40,6 +55,99 @@ inline thread_pool::~thread_pool()
   join();
 }
 
+inline scheduler_options thread_pool::_Scheduler_options(const scheduler_options& __options)
+{
+  // The pool's threads always receive work from other threads.
+  scheduler_options __o(__options);
+  __o.single_threaded = false;
+  return __o;
+}
+
+// Must be called with _M_threads_mutex held. A new thread takes the lowest
+// placement index given up by a retired thread, so that no two running threads
+// are placed on the same processor.
+inline void thread_pool::_Start_thread()
+{
+  size_t __index = _M_threads.size();
+  if (!_M_free_indices.empty())
+  {
+    auto __lowest = min_element(_M_free_indices.begin(), _M_free_indices.end());
+    __index = *__lowest;
+    _M_free_indices.erase(__lowest);
+  }
+
+  _M_threads.emplace_back([this, __index](){ _Thread_main(__index); });
+  ++_M_num_threads;
+  _M_last_grow = chrono::steady_clock::now();
+}
+
+inline void thread_pool::_Thread_main(size_t __index)
+{
+  if (_M_options.placement != thread_placement::none)
+    __cpu_topology::_Instance()._Place_this_thread(_M_options, __index);
+
+  if (!_M_elastic)
+  {
+    _Run();
+    return;
+  }
+
+  for (;;)
+  {
+    _Run_while_busy(_M_options.idle_timeout);
+    if (_Stopped() || _Retire_this_thread(__index))
+      return;
+  }
+}
+
+// Called by a thread of an elastic pool that has found no work for the idle
+// timeout. The thread exits if the pool has more than its minimum number of
+// threads, handing its thread object over to be joined later.
+inline bool thread_pool::_Retire_this_thread(size_t __index)
+{
+  lock_guard<mutex> __lock(_M_threads_mutex);
+  if (_M_joining || _M_threads.size() <= _M_min_threads)
+    return false;
+
+  for (auto __i = _M_threads.begin(); __i != _M_threads.end(); ++__i)
+  {
+    if (__i->get_id() == this_thread::get_id())
+    {
+      _M_retired_threads.push_back(std::move(*__i));
+      _M_threads.erase(__i);
+      _M_free_indices.push_back(__index);
+      --_M_num_threads;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+inline void thread_pool::_Grow_if_backlogged()
+{
+  if (!_M_elastic || _M_num_threads.load(memory_order_relaxed) >= _M_options.max_threads)
+    return;
+
+  if (!_Backlogged(_M_options.grow_queue_depth, _M_options.grow_latency))
+    return;
+
+  lock_guard<mutex> __lock(_M_threads_mutex);
+  if (_M_joining || _M_threads.size() >= _M_options.max_threads)
+    return;
+
+  // Give the most recently started thread a chance to take some of the load
+  // before deciding that another is needed.
+  if (chrono::steady_clock::now() - _M_last_grow < _M_options.grow_latency)
+    return;
+
+  for (auto& __t: _M_retired_threads)
+    __t.join();
+  _M_retired_threads.clear();
+
+  _Start_thread();
+}
+
 inline thread_pool::executor_type thread_pool::get_executor() const noexcept
 {
   return executor_type(const_cast<thread_pool*>(this));
@@ -52,13 +160,32 @@ inline void thread_pool::stop()
 
 inline void thread_pool::join()
 {
-  if (!_M_threads.empty())
   {
-    _Work_finished();
-    for (auto& __t: _M_threads)
-      __t.join();
-    _M_threads.clear();
+    lock_guard<mutex> __lock(_M_threads_mutex);
+    if (_M_threads.empty() || _M_joining)
+      return;
+    _M_joining = true;
   }
+
+  _Work_finished();
+
+  // Once joining has started the set of threads can no longer change.
+  for (auto& __t: _M_threads)
+    __t.join();
+  for (auto& __t: _M_retired_threads)
+    __t.join();
+
+  lock_guard<mutex> __lock(_M_threads_mutex);
+  _M_threads.clear();
+  _M_retired_threads.clear();
+  _M_free_indices.clear();
+  _M_num_threads = 0;
+  _M_joining = false;
+}
+
+inline scheduler_statistics thread_pool::statistics() const
+{
+  return _Statistics();
 }
 
 inline bool thread_pool::executor_type::running_in_this_thread() const noexcept
@@ -85,18 +212,35 @@ template <class _Func, class _Alloc>
 void thread_pool::executor_type::dispatch(_Func&& __f, const _Alloc& __a)
 {
   _M_pool->_Dispatch(forward<_Func>(__f), __a);
+  _M_pool->_Grow_if_backlogged();
 }
 
 template <class _Func, class _Alloc>
 void thread_pool::executor_type::post(_Func&& __f, const _Alloc& __a)
 {
   _M_pool->_Post(forward<_Func>(__f), __a);
+  _M_pool->_Grow_if_backlogged();
 }
 
 template <class _Func, class _Alloc>
 void thread_pool::executor_type::defer(_Func&& __f, const _Alloc& __a)
 {
   _M_pool->_Defer(forward<_Func>(__f), __a);
+  _M_pool->_Grow_if_backlogged();
+}
+
+template <class _InputIterator, class _Alloc>
+void thread_pool::executor_type::post_range(_InputIterator __first, _InputIterator __last, const _Alloc& __a)
+{
+  _M_pool->_Post_range(__first, __last, __a);
+  _M_pool->_Grow_if_backlogged();
+}
+
+template <class _Alloc, class... _Funcs>
+void thread_pool::executor_type::post_each(const _Alloc& __a, _Funcs&&... __fs)
+{
+  _M_pool->_Post_each(__a, forward<_Funcs>(__fs)...);
+  _M_pool->_Grow_if_backlogged();
 }
 
 inline bool operator==(const thread_pool::executor_type& __a, const thread_pool::executor_type& __b) noexcept
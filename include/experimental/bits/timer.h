@@ -18,7 +18,7 @@
 #include <experimental/type_traits>
 #include <experimental/bits/invoker.h>
 #include <experimental/bits/reactor.h>
-#include <experimental/bits/timer_queue.h>
+#include <experimental/bits/timer_wheel.h>
 
 namespace std {
 namespace experimental {
@@ -111,7 +111,7 @@ public:
 private:
   template <class, class> friend class basic_timer;
   __reactor& _M_reactor;
-  __timer_queue<_Clock, _TimerTraits> _M_queue;
+  __timer_queue_for<_Clock, _TimerTraits> _M_queue;
 };
 
 template <class _Clock, class _TimerTraits>
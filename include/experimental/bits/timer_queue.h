@@ -152,6 +152,20 @@ public:
     }
   }
 
+  // Take the operations of the timer that expires first, whether or not it has
+  // expired yet. Timers that never expire are not considered.
+  bool _Get_first_timer(__op_queue<__operation>& __ops, _Time_point& __expiry)
+  {
+    if (_M_heap.empty())
+      return false;
+
+    __per_timer_data* __timer = _M_heap[0]._M_timer;
+    __expiry = _M_heap[0]._M_expiry;
+    __ops._Push(__timer->_M_ops);
+    _Remove_timer(*__timer);
+    return true;
+  }
+
   virtual void _Get_all_timers(__op_queue<__operation>& __ops)
   {
     while (_M_timers)
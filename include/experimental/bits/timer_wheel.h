@@ -0,0 +1,399 @@
+//
+// timer_wheel.h
+// ~~~~~~~~~~~~~
+// Hierarchical timing wheel.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_TIMER_WHEEL_H
+#define EXECUTORS_EXPERIMENTAL_BITS_TIMER_WHEEL_H
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <experimental/bits/timer_queue.h>
+#include <experimental/bits/wait_op.h>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// Timers are kept in a hierarchy of wheels, each with 64 slots. Expiry times
+// are rounded up to a whole number of ticks, counted from when the queue was
+// created. A timer is placed in the lowest wheel whose slot is chosen by the
+// bits where its tick first differs from the current tick, so adding and
+// cancelling a timer take constant time. As the current tick advances, each
+// slot of a higher wheel is emptied into the wheels below it just as its
+// range of ticks begins, and timers in the lowest wheel expire when their
+// tick is reached. Timers may expire up to one tick late, but never early.
+
+template <class _Clock, class _TimerTraits>
+class __timer_wheel
+  : public __timer_queue_base
+{
+public:
+  typedef typename _Clock::time_point _Time_point;
+  typedef typename _Clock::duration _Duration;
+
+  class __per_timer_data
+  {
+  public:
+    __per_timer_data() : _M_tick(0), _M_slot(nullptr), _M_next(nullptr), _M_prev(nullptr) {}
+
+  private:
+    friend class __timer_wheel;
+    __op_queue<__wait_op_base> _M_ops;
+    uint64_t _M_tick;
+    __per_timer_data** _M_slot;
+    __per_timer_data* _M_next;
+    __per_timer_data* _M_prev;
+  };
+
+  __timer_wheel()
+    : _M_epoch(_Clock::now()), _M_tick(_Tick_duration()), _M_current(0), _M_count(0),
+      _M_never(nullptr), _M_never_count(0)
+  {
+    for (size_t __level = 0; __level < _S_levels; ++__level)
+    {
+      _M_occupied[__level] = 0;
+      for (size_t __i = 0; __i < _S_slots; ++__i)
+        _M_slots[__level][__i] = nullptr;
+    }
+  }
+
+  void _Move_timer(__per_timer_data& __empty_target, __per_timer_data& __source)
+  {
+    __empty_target._M_ops._Push(__source._M_ops);
+    __empty_target._M_tick = __source._M_tick;
+
+    __empty_target._M_slot = __source._M_slot;
+    __source._M_slot = nullptr;
+    if (__empty_target._M_slot && *__empty_target._M_slot == &__source)
+      *__empty_target._M_slot = &__empty_target;
+
+    __empty_target._M_prev = __source._M_prev;
+    __source._M_prev = nullptr;
+    if (__empty_target._M_prev)
+      __empty_target._M_prev->_M_next = &__empty_target;
+
+    __empty_target._M_next = __source._M_next;
+    __source._M_next = nullptr;
+    if (__empty_target._M_next)
+      __empty_target._M_next->_M_prev = &__empty_target;
+  }
+
+  bool _Enqueue_timer(const _Time_point& __t, __per_timer_data& __timer, __wait_op_base* __op)
+  {
+    bool __first = false;
+    if (__timer._M_slot == nullptr)
+    {
+      if (__t == (_Time_point::max)())
+      {
+        // Timers that never expire are kept apart from the wheels.
+        _Link(&_M_never, __timer);
+        ++_M_never_count;
+      }
+      else
+      {
+        __timer._M_tick = _Tick_at(__t);
+        __first = _M_count == 0 || __timer._M_tick < _Next_tick();
+        _Insert(__timer);
+        ++_M_count;
+      }
+    }
+
+    __timer._M_ops._Push(__op);
+
+    // Interrupt reactor only if newly added timer is first to expire.
+    return __first;
+  }
+
+  virtual bool _Empty() const
+  {
+    return _M_count == 0 && _M_never_count == 0;
+  }
+
+  virtual chrono::steady_clock::duration _Wait_duration(
+    chrono::steady_clock::duration __max_duration) const
+  {
+    if (_M_count == 0)
+      return __max_duration;
+
+    uint64_t __tick = _Next_tick();
+    if (__tick > _Tick_count((_Time_point::max)() - _M_epoch))
+      return __max_duration;
+
+    chrono::steady_clock::duration __d = _TimerTraits::to_duration(_M_epoch
+        + _Duration(_M_tick.count() * static_cast<typename _Duration::rep>(__tick)));
+    if (__d < chrono::steady_clock::duration::zero())
+      return chrono::steady_clock::duration::zero();
+    return __d < __max_duration ? __d : __max_duration;
+  }
+
+  virtual void _Get_ready_timers(__op_queue<__operation>& __ops)
+  {
+    if (_M_count == 0)
+      return;
+
+    const _Time_point __now = _Clock::now();
+    if (__now < _M_epoch)
+      return;
+
+    const uint64_t __now_tick = _Tick_count(__now - _M_epoch);
+    while (_M_current <= __now_tick)
+    {
+      _Cascade();
+
+      const size_t __index = _M_current % _S_slots;
+      while (__per_timer_data* __timer = _M_slots[0][__index])
+      {
+        __ops._Push(__timer->_M_ops);
+        _Remove(*__timer);
+      }
+
+      // Skip over ticks at which there is nothing to do.
+      const uint64_t __next = _M_count > 0 ? _Next_tick(_M_current + 1) : __now_tick + 1;
+      _M_current = __next < __now_tick + 1 ? __next : __now_tick + 1;
+    }
+  }
+
+  virtual void _Get_all_timers(__op_queue<__operation>& __ops)
+  {
+    for (size_t __level = 0; __level < _S_levels; ++__level)
+    {
+      for (size_t __i = 0; __i < _S_slots; ++__i)
+      {
+        while (__per_timer_data* __timer = _M_slots[__level][__i])
+        {
+          __ops._Push(__timer->_M_ops);
+          _Remove(*__timer);
+        }
+      }
+    }
+
+    while (__per_timer_data* __timer = _M_never)
+    {
+      __ops._Push(__timer->_M_ops);
+      _Unlink(*__timer);
+    }
+    _M_never_count = 0;
+  }
+
+  bool _Cancel_timer(__per_timer_data& __timer,
+    __op_queue<__operation>& __ops, size_t __max = ~size_t(0))
+  {
+    size_t __num = 0;
+    if (__timer._M_slot != nullptr)
+    {
+      while (__wait_op_base* __op = (__num != __max) ? __timer._M_ops._Front() : nullptr)
+      {
+        __op->_M_ec = make_error_code(errc::operation_canceled);
+        __timer._M_ops._Pop();
+        __ops._Push(__op);
+        ++__num;
+      }
+      if (__timer._M_ops._Empty())
+        _Remove(__timer);
+    }
+    return __num != 0;
+  }
+
+private:
+  static constexpr size_t _S_bits = 6;
+  static constexpr size_t _S_slots = size_t(1) << _S_bits;
+  static constexpr size_t _S_levels = 6;
+  static constexpr uint64_t _S_range = uint64_t(1) << (_S_bits * _S_levels);
+
+  static _Duration _Tick_duration()
+  {
+    _Duration __tick = chrono::duration_cast<_Duration>(typename _TimerTraits::tick_duration(1));
+    return __tick > _Duration::zero() ? __tick : _Duration(1);
+  }
+
+  // Number of whole ticks in __d.
+  uint64_t _Tick_count(const _Duration& __d) const
+  {
+    return static_cast<uint64_t>(__d.count() / _M_tick.count());
+  }
+
+  // The tick at which a timer expiring at __t must fire. Times that have
+  // already passed map to the current tick.
+  uint64_t _Tick_at(const _Time_point& __t) const
+  {
+    if (!(_M_epoch < __t))
+      return _M_current;
+    const _Duration __d = __t - _M_epoch;
+    uint64_t __tick = _Tick_count(__d);
+    if (__d > _Duration(_M_tick.count() * static_cast<typename _Duration::rep>(__tick)))
+      ++__tick;
+    return __tick > _M_current ? __tick : _M_current;
+  }
+
+  // Place a timer in the lowest wheel that can hold it. A timer too far in the
+  // future goes in the highest wheel, and is placed again when its slot is
+  // emptied.
+  void _Insert(__per_timer_data& __timer)
+  {
+    uint64_t __tick = __timer._M_tick;
+    if (__tick - _M_current >= _S_range)
+      __tick = _M_current + _S_range - 1;
+
+    size_t __level = 0;
+    while (__level + 1 < _S_levels
+        && ((__tick ^ _M_current) >> (_S_bits * (__level + 1))) != 0)
+      ++__level;
+
+    const size_t __index = (__tick >> (_S_bits * __level)) % _S_slots;
+    _M_occupied[__level] |= uint64_t(1) << __index;
+    _Link(&_M_slots[__level][__index], __timer);
+  }
+
+  void _Link(__per_timer_data** __slot, __per_timer_data& __timer)
+  {
+    __timer._M_slot = __slot;
+    __timer._M_prev = nullptr;
+    __timer._M_next = *__slot;
+    if (*__slot)
+      (*__slot)->_M_prev = &__timer;
+    *__slot = &__timer;
+  }
+
+  void _Unlink(__per_timer_data& __timer)
+  {
+    if (*__timer._M_slot == &__timer)
+    {
+      *__timer._M_slot = __timer._M_next;
+      if (*__timer._M_slot == nullptr && __timer._M_slot != &_M_never)
+      {
+        const size_t __offset = __timer._M_slot - &_M_slots[0][0];
+        _M_occupied[__offset / _S_slots] &= ~(uint64_t(1) << (__offset % _S_slots));
+      }
+    }
+    if (__timer._M_prev)
+      __timer._M_prev->_M_next = __timer._M_next;
+    if (__timer._M_next)
+      __timer._M_next->_M_prev = __timer._M_prev;
+    __timer._M_slot = nullptr;
+    __timer._M_next = nullptr;
+    __timer._M_prev = nullptr;
+  }
+
+  void _Remove(__per_timer_data& __timer)
+  {
+    if (__timer._M_slot == &_M_never)
+      --_M_never_count;
+    else
+      --_M_count;
+    _Unlink(__timer);
+  }
+
+  // Empty the slots of the higher wheels whose range begins at the current
+  // tick, highest first, so that their timers fall into the wheels below.
+  void _Cascade()
+  {
+    for (size_t __level = _S_levels - 1; __level > 0; --__level)
+    {
+      if (_M_current % (uint64_t(1) << (_S_bits * __level)) != 0)
+        continue;
+
+      const size_t __index = (_M_current >> (_S_bits * __level)) % _S_slots;
+      while (__per_timer_data* __timer = _M_slots[__level][__index])
+      {
+        _Unlink(*__timer);
+        _Insert(*__timer);
+      }
+    }
+  }
+
+  // Find the first occupied slot at or after __index, or _S_slots if none.
+  static size_t _First_occupied(uint64_t __bits, size_t __index)
+  {
+    __bits = __index < _S_slots ? __bits >> __index << __index : 0;
+    if (__bits == 0)
+      return _S_slots;
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(__bits));
+#else
+    size_t __i = 0;
+    while ((__bits & 1) == 0)
+      __bits >>= 1, ++__i;
+    return __i;
+#endif
+  }
+
+  // The first tick, at or after __from, at which a timer expires or a slot
+  // must be emptied into a lower wheel. A slot whose range began before __from
+  // has already been emptied, except in the highest wheel, where it and the
+  // slots before it hold timers for the wheel's next revolution.
+  uint64_t _Next_tick(uint64_t __from) const
+  {
+    uint64_t __next = ~uint64_t(0);
+    for (size_t __level = 0; __level < _S_levels; ++__level)
+    {
+      const size_t __shift = _S_bits * __level;
+      uint64_t __base = __from >> (__shift + _S_bits) << (__shift + _S_bits);
+      size_t __start = (__from >> __shift) % _S_slots;
+      if (__from % (uint64_t(1) << __shift) != 0)
+        ++__start;
+
+      size_t __index = _First_occupied(_M_occupied[__level], __start);
+      if (__index == _S_slots && __level + 1 == _S_levels)
+      {
+        __index = _First_occupied(_M_occupied[__level], 0);
+        __base += _S_range;
+      }
+
+      if (__index < _S_slots)
+      {
+        const uint64_t __tick = __base + (uint64_t(__index) << __shift);
+        if (__tick < __next)
+          __next = __tick;
+      }
+    }
+    return __next;
+  }
+
+  uint64_t _Next_tick() const
+  {
+    return _Next_tick(_M_current);
+  }
+
+  const _Time_point _M_epoch;
+  const _Duration _M_tick;
+  uint64_t _M_current;
+  size_t _M_count;
+  uint64_t _M_occupied[_S_levels];
+  __per_timer_data* _M_slots[_S_levels][_S_slots];
+  __per_timer_data* _M_never;
+  size_t _M_never_count;
+};
+
+// Timers use a timing wheel when their traits class defines tick_duration,
+// and a heap otherwise.
+
+template <class _T>
+struct __timer_void_type
+{
+  typedef void _Type;
+};
+
+template <class _TimerTraits, class = void>
+struct __has_tick_duration : false_type {};
+
+template <class _TimerTraits>
+struct __has_tick_duration<_TimerTraits,
+  typename __timer_void_type<typename _TimerTraits::tick_duration>::_Type> : true_type {};
+
+template <class _Clock, class _TimerTraits>
+using __timer_queue_for = typename conditional<__has_tick_duration<_TimerTraits>::value,
+  __timer_wheel<_Clock, _TimerTraits>, __timer_queue<_Clock, _TimerTraits>>::type;
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
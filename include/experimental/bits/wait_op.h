@@ -27,6 +27,7 @@ class __wait_op_base
 {
 protected:
   template <class _Clock, class _TimerTraits> friend class __timer_queue;
+  template <class _Clock, class _TimerTraits> friend class __timer_wheel;
   error_code _M_ec;
 };
 
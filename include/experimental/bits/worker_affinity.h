@@ -0,0 +1,101 @@
+//
+// worker_affinity.h
+// ~~~~~~~~~~~~~~~~~
+// Records which scheduler thread last ran a sequence of operations.
+//
+// Copyright (c) 2014 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef EXECUTORS_EXPERIMENTAL_BITS_WORKER_AFFINITY_H
+#define EXECUTORS_EXPERIMENTAL_BITS_WORKER_AFFINITY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace std {
+namespace experimental {
+inline namespace concurrency_v1 {
+
+// Identifies the worker of a work-stealing scheduler that the calling thread
+// is running, if any. Set by the scheduler for as long as the thread runs it.
+
+struct __worker_id
+{
+  const void* _M_scheduler;
+  size_t _M_index;
+  atomic<uint64_t>* _M_migrations;
+};
+
+inline __worker_id& __this_worker() noexcept
+{
+  static thread_local __worker_id __id = { nullptr, 0, nullptr };
+  return __id;
+}
+
+// A sequence of operations that must not run concurrently, such as those of a
+// strand, notes the worker that runs each of its invocations. A scheduler may
+// then queue the sequence's next invocation on that worker, so that state used
+// only by the sequence stays in one processor's cache. An invocation that runs
+// on a different worker of the same scheduler is counted as a migration.
+
+class __worker_affinity
+{
+public:
+  __worker_affinity() noexcept
+    : _M_scheduler(nullptr), _M_index(0)
+  {
+  }
+
+  __worker_affinity(const __worker_affinity&) = delete;
+  __worker_affinity& operator=(const __worker_affinity&) = delete;
+
+  // Called at the start of each invocation. Invocations of a sequence are
+  // never concurrent, so only readers race with the update.
+  void _Record() noexcept
+  {
+    const __worker_id& __id = __this_worker();
+    if (!__id._M_scheduler)
+      return;
+
+    if (_M_scheduler.load(memory_order_relaxed) == __id._M_scheduler)
+    {
+      if (_M_index.load(memory_order_relaxed) == __id._M_index)
+        return;
+      __id._M_migrations->fetch_add(1, memory_order_relaxed);
+    }
+
+    _M_index.store(__id._M_index, memory_order_relaxed);
+    _M_scheduler.store(__id._M_scheduler, memory_order_relaxed);
+  }
+
+  // Get the worker of the given scheduler that last ran the sequence. The
+  // answer is only a hint, and the index must be checked before it is used.
+  bool _Last_worker(const void* __scheduler, size_t& __index) const noexcept
+  {
+    __index = _M_index.load(memory_order_relaxed);
+    return _M_scheduler.load(memory_order_relaxed) == __scheduler;
+  }
+
+private:
+  atomic<const void*> _M_scheduler;
+  atomic<size_t> _M_index;
+};
+
+// Function objects that run a sequence with affinity overload this to expose
+// it to the scheduler.
+
+template <class _Func>
+inline const __worker_affinity* __affinity_of(const _Func&) noexcept
+{
+  return nullptr;
+}
+
+} // inline namespace concurrency_v1
+} // namespace experimental
+} // namespace std
+
+#endif
@@ -0,0 +1,51 @@
+#include <experimental/deadline_scheduler>
+#include <experimental/executor>
+#include <experimental/strand>
+#include <experimental/timer>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+int main()
+{
+  std::experimental::deadline_scheduler scheduler;
+  std::experimental::executor_work<std::experimental::deadline_scheduler::executor_type>
+    w(scheduler.get_executor());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back([&]{ scheduler.run(); });
+
+  auto now = std::chrono::steady_clock::now();
+  std::atomic<int> count(0);
+  for (int i = 0; i < 10000; ++i)
+  {
+    auto ex = (i % 5 == 0) ? scheduler.get_executor()
+      : scheduler.get_executor(now + std::chrono::milliseconds(i % 97));
+    std::experimental::post(ex, [&]{ ++count; });
+  }
+
+  // Function objects on a strand are not run concurrently, whatever their
+  // deadline.
+  int strand_count = 0;
+  std::experimental::strand<std::experimental::deadline_scheduler::executor_type>
+    s(scheduler.get_executor(now + std::chrono::seconds(1)));
+  for (int i = 0; i < 1000; ++i)
+    std::experimental::post(s, [&]{ ++strand_count; });
+
+  // Timers deliver their function objects through the executor.
+  std::atomic<int> timer_count(0);
+  std::experimental::dispatch_after(std::chrono::milliseconds(10),
+    scheduler.get_executor(now + std::chrono::seconds(1)), [&]{ ++timer_count; });
+  std::experimental::dispatch_after(std::chrono::milliseconds(20),
+    scheduler.get_executor(), [&]{ ++timer_count; w.reset(); });
+
+  for (auto& t: threads)
+    t.join();
+
+  assert(count == 10000);
+  assert(strand_count == 1000);
+  assert(timer_count == 2);
+}
@@ -0,0 +1,69 @@
+#include <experimental/deadline_scheduler>
+#include <experimental/executor>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+int main()
+{
+  std::experimental::deadline_scheduler scheduler;
+
+  auto now = std::chrono::steady_clock::now();
+  auto best_effort = scheduler.get_executor();
+  auto soon = scheduler.get_executor(now + std::chrono::seconds(10));
+  auto later = scheduler.get_executor(now + std::chrono::seconds(20));
+  auto latest = scheduler.get_executor(now + std::chrono::seconds(30));
+  assert(best_effort.deadline() == std::chrono::steady_clock::time_point::max());
+  assert(soon.deadline() == now + std::chrono::seconds(10));
+  assert(soon == scheduler.get_executor(now + std::chrono::seconds(10)));
+  assert(soon != later);
+  assert(&soon.context() == &scheduler);
+
+  std::vector<int> order;
+  std::experimental::post(best_effort, [&]{ order.push_back(0); });
+  std::experimental::post(latest, [&]{ order.push_back(1); });
+  std::experimental::post(soon, [&]{ order.push_back(2); });
+  std::experimental::post(best_effort, [&]{ order.push_back(3); });
+  std::experimental::post(later, [&]{ order.push_back(4); });
+
+  assert(scheduler.run() == 5);
+  assert((order == std::vector<int>{ 2, 4, 1, 0, 3 }));
+  assert(scheduler.deadline_misses() == 0);
+
+  // Work posted from a running function object is ordered by deadline, and
+  // dispatch runs immediately.
+  order.clear();
+  scheduler.restart();
+  std::experimental::post(later,
+    [&]
+    {
+      order.push_back(0);
+      std::experimental::post(best_effort, [&]{ order.push_back(1); });
+      std::experimental::post(soon, [&]{ order.push_back(2); });
+      std::experimental::dispatch(latest, [&]{ order.push_back(3); });
+    });
+
+  assert(scheduler.run() == 3);
+  assert((order == std::vector<int>{ 0, 3, 2, 1 }));
+
+  // Function objects that finish after their deadline are counted as misses.
+  scheduler.restart();
+  auto past = scheduler.get_executor(std::chrono::steady_clock::now());
+  auto tight = scheduler.get_executor(
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(1));
+  std::experimental::post(past, []{});
+  std::experimental::post(tight,
+    []{ std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+  std::experimental::post(best_effort,
+    []{ std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+  std::experimental::post(later, []{});
+
+  assert(scheduler.run() == 4);
+  assert(scheduler.deadline_misses() == 2);
+
+  // Pending function objects are destroyed with the scheduler.
+  std::experimental::deadline_scheduler unrun;
+  std::experimental::post(unrun.get_executor(now), []{});
+  std::experimental::post(unrun.get_executor(), []{});
+}
@@ -0,0 +1,44 @@
+#include <experimental/deadline_scheduler>
+#include <experimental/executor>
+#include <cassert>
+#include <chrono>
+#include <functional>
+
+int main()
+{
+  std::experimental::deadline_scheduler scheduler;
+  auto best_effort = scheduler.get_executor();
+  auto urgent = scheduler.get_executor(std::chrono::steady_clock::now());
+
+  // Handlers that always re-post themselves keep the queue non-empty, so the
+  // timed run functions must still return once their deadline has passed.
+  int count = 0;
+  std::function<void()> spin = [&]
+  {
+    ++count;
+    std::experimental::post(best_effort, spin);
+  };
+  std::function<void()> urgent_spin = [&]
+  {
+    ++count;
+    std::experimental::post(urgent, urgent_spin);
+  };
+  std::experimental::post(best_effort, spin);
+  std::experimental::post(urgent, urgent_spin);
+
+  auto start = std::chrono::steady_clock::now();
+  scheduler.run_for(std::chrono::milliseconds(10));
+  assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+  assert(count > 0);
+
+  start = std::chrono::steady_clock::now();
+  scheduler.run_until(start + std::chrono::milliseconds(10));
+  assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+
+  // A deadline that has already passed runs nothing.
+  int before = count;
+  assert(scheduler.run_one_until(start) == 0);
+  assert(count == before);
+  assert(scheduler.run_one_for(std::chrono::milliseconds(10)) == 1);
+  assert(count == before + 1);
+}
@@ -0,0 +1,29 @@
+#include <experimental/deadline_scheduler>
+#include <experimental/executor>
+#include <experimental/timer>
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+int main()
+{
+  // A timer's function object releases the last of the scheduler's work, so
+  // the scheduler is destroyed while the timer's thread may still be
+  // completing it. Destruction must not wait for the timer thread's next
+  // periodic wakeup.
+  for (int i = 0; i < 20; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    {
+      std::experimental::deadline_scheduler scheduler;
+      std::experimental::executor_work<std::experimental::deadline_scheduler::executor_type>
+        w(scheduler.get_executor());
+
+      std::thread t([&]{ scheduler.run(); });
+      std::experimental::dispatch_after(std::chrono::milliseconds(1),
+        scheduler.get_executor(), [&]{ w.reset(); });
+      t.join();
+    }
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+  }
+}
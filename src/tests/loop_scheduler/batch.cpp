@@ -0,0 +1,56 @@
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+std::vector<int> order;
+std::atomic<int> count(0);
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  options.batch_size = 16;
+
+  // Operations taken in a batch still run in FIFO order, and are returned to
+  // the front of the queue if the scheduler is stopped part way through.
+  std::experimental::loop_scheduler s1(1, options);
+  auto ex1 = s1.get_executor();
+
+  for (int i = 0; i < 100; ++i)
+  {
+    std::experimental::post(ex1, [&s1, i]
+      {
+        order.push_back(i);
+        if (i == 10)
+          s1.stop();
+      });
+  }
+
+  s1.run();
+  assert(order.size() == 11);
+  assert(s1.stopped());
+
+  s1.restart();
+  s1.run();
+  assert(order.size() == 100);
+  for (int i = 0; i < 100; ++i)
+    assert(order[i] == i);
+
+  // Multiple threads share a burst of operations.
+  std::experimental::loop_scheduler s2(4, options);
+  auto ex2 = s2.get_executor();
+
+  for (int i = 0; i < 10000; ++i)
+    std::experimental::post(ex2, []{ ++count; });
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i)
+    threads.emplace_back([&]{ s2.run(); });
+  s2.run();
+  for (auto& t: threads)
+    t.join();
+
+  assert(count == 10000);
+}
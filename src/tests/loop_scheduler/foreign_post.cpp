@@ -0,0 +1,100 @@
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+const int producers = 4;
+const int posts_per_producer = 20000;
+
+void test(const std::experimental::scheduler_options& options)
+{
+  // Operations posted from other threads into a single-threaded scheduler are
+  // all run, in the order each thread posted them.
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    auto work = std::experimental::make_work(ex);
+
+    std::vector<int> next(producers, 0);
+    bool in_order = true;
+    std::atomic<int> remaining(producers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+      threads.emplace_back([&, p]{
+          for (int i = 0; i < posts_per_producer; ++i)
+          {
+            std::experimental::post(ex, [&, p, i]{ in_order = in_order && next[p]++ == i; });
+            if (i % 1000 == 0)
+              std::this_thread::sleep_for(std::chrono::microseconds(100));
+          }
+          std::experimental::post(ex, [&]{ if (--remaining == 0) work.reset(); });
+        });
+    }
+
+    s.run();
+    for (auto& t: threads)
+      t.join();
+
+    assert(in_order);
+    for (int p = 0; p < producers; ++p)
+      assert(next[p] == posts_per_producer);
+  }
+
+  // A scheduler that is waiting for work is woken by a post from another
+  // thread, as is one that is waiting with a timeout.
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    int count = 0;
+    std::thread t([&]{
+        for (int i = 0; i < 10; ++i)
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          std::experimental::post(ex, [&]{ ++count; });
+        }
+      });
+
+    auto work = std::experimental::make_work(ex);
+    while (count < 10)
+      s.run_one_for(std::chrono::seconds(10));
+    t.join();
+    assert(count == 10);
+
+    // A range posted from another thread is injected in one step.
+    std::vector<std::function<void()>> functions(3, [&]{ ++count; });
+    std::thread t2([&]{ ex.post_range(functions.begin(), functions.end(), std::allocator<void>()); });
+    t2.join();
+    assert(s.poll() == 3);
+    assert(count == 13);
+  }
+
+  // Operations posted from another thread and never run are destroyed with
+  // the scheduler.
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    std::thread t([&]{ std::experimental::post(ex, []{}); });
+    t.join();
+  }
+}
+
+int main()
+{
+  test(std::experimental::scheduler_options());
+
+  std::experimental::scheduler_options spinning;
+  spinning.spin_count = 100;
+  spinning.yield_count = 10;
+  test(spinning);
+
+  std::experimental::scheduler_options batched;
+  batched.batch_size = 8;
+  test(batched);
+}
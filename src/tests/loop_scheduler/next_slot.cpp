@@ -0,0 +1,126 @@
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <thread>
+#include <vector>
+
+std::atomic<int> count(0);
+
+void chain(std::experimental::loop_scheduler::executor_type ex, int i)
+{
+  ++count;
+  if (i > 0)
+    std::experimental::post(ex, [=]{ chain(ex, i - 1); });
+}
+
+void test_order(size_t hint)
+{
+  std::experimental::scheduler_options options;
+  options.next_slot_budget = 2;
+
+  // A follow-up posted by a handler runs before operations already queued.
+  {
+    std::experimental::loop_scheduler s(hint, options);
+    auto ex = s.get_executor();
+    std::vector<int> order;
+    std::experimental::post(ex, [&]{
+        order.push_back(0);
+        std::experimental::post(ex, [&]{ order.push_back(1); });
+      });
+    std::experimental::post(ex, [&]{ order.push_back(2); });
+    s.run();
+    assert((order == std::vector<int>{ 0, 1, 2 }));
+  }
+
+  // Only the most recent post takes the slot.
+  {
+    std::experimental::loop_scheduler s(hint, options);
+    auto ex = s.get_executor();
+    std::vector<int> order;
+    std::experimental::post(ex, [&]{
+        order.push_back(0);
+        std::experimental::post(ex, [&]{ order.push_back(1); });
+        std::experimental::post(ex, [&]{ order.push_back(2); });
+      });
+    std::experimental::post(ex, [&]{ order.push_back(3); });
+    s.run();
+    assert((order == std::vector<int>{ 0, 2, 3, 1 }));
+  }
+
+  // The budget stops a chain from starving queued operations.
+  {
+    std::experimental::loop_scheduler s(hint, options);
+    auto ex = s.get_executor();
+    std::vector<int> order;
+    std::function<void(int)> link = [&](int i){
+        order.push_back(i);
+        if (i < 15)
+          std::experimental::post(ex, [&, i]{ link(i + 1); });
+      };
+    std::experimental::post(ex, [&]{ link(10); });
+    std::experimental::post(ex, [&]{ order.push_back(0); });
+    s.run();
+    assert((order == std::vector<int>{ 10, 11, 12, 0, 13, 14, 15 }));
+  }
+
+  // An operation left in the slot when the scheduler stops runs after restart.
+  {
+    std::experimental::loop_scheduler s(hint, options);
+    auto ex = s.get_executor();
+    int n = 0;
+    std::experimental::post(ex, [&]{
+        ++n;
+        std::experimental::post(ex, [&]{ ++n; });
+        s.stop();
+      });
+    assert(s.run() == 1);
+    assert(n == 1);
+    s.restart();
+    assert(s.run() == 1);
+    assert(n == 2);
+  }
+
+  // Likewise for an operation posted by run_one.
+  {
+    std::experimental::loop_scheduler s(hint, options);
+    auto ex = s.get_executor();
+    count = 0;
+    std::experimental::post(ex, [=]{ chain(ex, 2); });
+    assert(s.run_one() == 1);
+    assert(s.poll_one() == 1);
+    assert(s.run() == 1);
+    assert(count == 3);
+  }
+}
+
+void test_threads(bool work_stealing)
+{
+  std::experimental::scheduler_options options;
+  options.next_slot_budget = 8;
+  options.work_stealing = work_stealing;
+
+  count = 0;
+  std::experimental::loop_scheduler s(4, options);
+  auto ex = s.get_executor();
+  for (int i = 0; i < 8; ++i)
+    std::experimental::post(ex, [=]{ chain(ex, 9999); });
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back([&]{ s.run(); });
+  for (auto& t: threads)
+    t.join();
+
+  assert(count == 80000);
+  assert(s.stopped());
+}
+
+int main()
+{
+  test_order(1);
+  test_order(2);
+  test_threads(false);
+  test_threads(true);
+}
@@ -0,0 +1,77 @@
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+int count = 0;
+
+void chain(std::experimental::loop_scheduler::executor_type ex, int i)
+{
+  ++count;
+  if (i > 0)
+    std::experimental::post(ex, [=]{ chain(ex, i - 1); });
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  options.single_threaded = true;
+
+  // Chains of operations run in FIFO order, and the scheduler stops when they
+  // are complete.
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    std::vector<int> order;
+    std::experimental::post(ex, [&]{ order.push_back(0); std::experimental::post(ex, [&]{ order.push_back(2); }); });
+    std::experimental::post(ex, [&]{ order.push_back(1); std::experimental::dispatch(ex, [&]{ order.push_back(3); }); });
+    for (int i = 0; i < 4; ++i)
+      std::experimental::post(ex, [=]{ chain(ex, 999); });
+    assert(s.run() == 4003);
+    assert((order == std::vector<int>{ 0, 1, 3, 2 }));
+    assert(count == 4000);
+    assert(s.stopped());
+  }
+
+  // Run functions return when nothing is queued, even if work is outstanding.
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    auto work = std::experimental::make_work(ex);
+    count = 0;
+    std::experimental::post(ex, [=]{ chain(ex, 9); });
+    assert(s.run() == 10);
+    assert(!s.stopped());
+    assert(s.run_for(std::chrono::seconds(10)) == 0);
+    std::experimental::post(ex, [=]{ chain(ex, 1); });
+    assert(s.run_one() == 1);
+    assert(s.poll_one() == 1);
+    assert(s.poll() == 0);
+    assert(count == 12);
+    work.reset();
+    assert(s.stopped());
+  }
+
+  // Operations left behind by stop() run after restart().
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    count = 0;
+    std::experimental::post(ex, [&]{ ++count; std::experimental::post(ex, [&]{ ++count; }); s.stop(); });
+    std::experimental::post(ex, [&]{ ++count; });
+    assert(s.run() == 1);
+    assert(count == 1);
+    s.restart();
+    assert(s.run() == 2);
+    assert(count == 3);
+  }
+
+  // Operations that are never run are destroyed with the scheduler.
+  {
+    std::experimental::loop_scheduler s(1, options);
+    auto ex = s.get_executor();
+    std::experimental::post(ex, [=]{ chain(ex, 9); });
+    assert(s.run_one() == 1);
+  }
+}
@@ -0,0 +1,144 @@
+#include <experimental/loop_scheduler>
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+std::atomic<int> live(0);
+std::atomic<int> large_allocations(0);
+
+void* operator new(std::size_t n)
+{
+  if (n >= 4096)
+    ++large_allocations;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+struct counted
+{
+  counted() { ++live; }
+  counted(const counted&) { ++live; }
+  counted(counted&&) noexcept { ++live; }
+  ~counted() { --live; }
+};
+
+struct throwing_move
+{
+  throwing_move() {}
+  throwing_move(const throwing_move&) {}
+  throwing_move(throwing_move&&) noexcept(false) {}
+};
+
+int main()
+{
+  // More small operations than a thread's ring has slots are all run, in the
+  // order they were posted.
+  {
+    std::experimental::loop_scheduler s(1);
+    auto ex = s.get_executor();
+    std::vector<int> order;
+    for (int i = 0; i < 1000; ++i)
+      std::experimental::post(ex, [&order, i]{ order.push_back(i); });
+    assert(s.run() == 1000);
+    assert(order.size() == 1000);
+    for (int i = 0; i < 1000; ++i)
+      assert(order[i] == i);
+  }
+
+  // Handlers too large for a slot, or that may throw when moved, still run.
+  {
+    std::experimental::loop_scheduler s(1);
+    auto ex = s.get_executor();
+    int sum = 0;
+    struct { int values[64]; } big;
+    for (int i = 0; i < 64; ++i)
+      big.values[i] = i;
+    std::experimental::post(ex, [&sum, big]{ for (int v: big.values) sum += v; });
+    throwing_move t;
+    std::experimental::post(ex, [&sum, t]{ sum += 1000; });
+    s.run();
+    assert(sum == 64 * 63 / 2 + 1000);
+  }
+
+  // Operations that are never run are destroyed with the scheduler, and each
+  // handler is destroyed exactly once whether or not it runs.
+  {
+    {
+      std::experimental::loop_scheduler s(1);
+      auto ex = s.get_executor();
+      counted c;
+      for (int i = 0; i < 200; ++i)
+        std::experimental::post(ex, [c]{});
+      s.run_one();
+      s.stop();
+    }
+    assert(live == 0);
+  }
+
+  // Slots are given back by the thread that runs the operation, even after the
+  // posting thread has exited.
+  {
+    std::experimental::loop_scheduler s(1);
+    auto ex = s.get_executor();
+    std::atomic<int> count(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; ++p)
+      threads.emplace_back([&]{
+          for (int i = 0; i < 500; ++i)
+            std::experimental::post(ex, [&count]{ ++count; });
+        });
+    for (auto& t: threads)
+      t.join();
+    s.run();
+    assert(count == 2000);
+  }
+
+  // A thread that exits while operations in its ring are outstanding hands the
+  // ring on to the next thread, rather than leaking it.
+  {
+    std::experimental::loop_scheduler s(1);
+    auto ex = s.get_executor();
+    std::atomic<int> count(0);
+    large_allocations = 0;
+    for (int p = 0; p < 20; ++p)
+    {
+      std::thread t([&]{ std::experimental::post(ex, [&count]{ ++count; }); });
+      t.join();
+    }
+    assert(large_allocations <= 1);
+    s.run();
+    assert(count == 20);
+  }
+
+  // Operations created on one pool thread may complete on another.
+  {
+    std::experimental::thread_pool pool(4);
+    auto ex = pool.get_executor();
+    std::atomic<int> count(0);
+    for (int i = 0; i < 100; ++i)
+    {
+      std::experimental::post(ex, [&count, &ex]{
+          for (int j = 0; j < 100; ++j)
+            std::experimental::post(ex, [&count]{ ++count; });
+        });
+    }
+    pool.join();
+    assert(count == 10000);
+  }
+}
@@ -0,0 +1,89 @@
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+std::atomic<int> count(0);
+
+void chain(std::experimental::loop_scheduler::executor_type ex, int i)
+{
+  ++count;
+  if (i > 0)
+    std::experimental::post(ex, [=]{ chain(ex, i - 1); });
+}
+
+void run_threads(std::experimental::loop_scheduler& s, int n)
+{
+  std::vector<std::thread> threads;
+  for (int i = 0; i < n; ++i)
+    threads.emplace_back([&s]{ s.run(); });
+  for (auto& t: threads)
+    t.join();
+}
+
+void test(const std::experimental::scheduler_options& options)
+{
+  // Chains of operations submitted from within handlers.
+  {
+    count = 0;
+    std::experimental::loop_scheduler s(4, options);
+    auto ex = s.get_executor();
+    for (int i = 0; i < 4; ++i)
+      std::experimental::post(ex, [=]{ chain(ex, 9999); });
+    run_threads(s, 4);
+    assert(count == 40000);
+    assert(s.stopped());
+  }
+
+  // Work created inside a handler and released by a foreign thread keeps the
+  // scheduler running.
+  {
+    count = 0;
+    std::experimental::loop_scheduler s(4, options);
+    auto ex = s.get_executor();
+    std::thread foreign;
+    std::experimental::post(ex, [&]{
+        auto work = std::experimental::make_work(ex);
+        foreign = std::thread([ex, work]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            std::experimental::post(ex, []{ ++count; });
+            work.reset();
+          });
+      });
+    run_threads(s, 4);
+    assert(count == 1);
+    foreign.join();
+  }
+
+  // Work created and released inside handlers does not stop the scheduler
+  // early, nor keep it running.
+  {
+    count = 0;
+    std::experimental::loop_scheduler s(4, options);
+    auto ex = s.get_executor();
+    for (int i = 0; i < 100; ++i)
+    {
+      std::experimental::post(ex, [=]() mutable {
+          auto work = std::experimental::make_work(ex);
+          std::experimental::post(ex, [work]{ ++count; });
+        });
+    }
+    run_threads(s, 4);
+    assert(count == 100);
+  }
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  test(options);
+
+  options.batch_size = 8;
+  test(options);
+
+  options.work_stealing = true;
+  test(options);
+}
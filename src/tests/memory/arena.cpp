@@ -0,0 +1,126 @@
+#include <experimental/arena>
+#include <experimental/loop_scheduler>
+#include <experimental/thread_pool>
+#include <experimental/timer>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+std::atomic<long> allocations(0);
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+struct hop
+{
+  std::experimental::thread_pool::executor_type ex;
+  std::experimental::arena* a;
+  int remaining;
+  long* allocations_at_start;
+  long* allocations_at_end;
+  char padding[256];
+
+  void operator()()
+  {
+    if (remaining == 990)
+      *allocations_at_start = allocations;
+    if (--remaining == 0)
+    {
+      *allocations_at_end = allocations;
+      return;
+    }
+    hop next(*this);
+    std::experimental::post(ex, std::experimental::wrap(std::allocator_arg, a->get_allocator(), next));
+  }
+};
+
+int main()
+{
+  // Operations posted with an arena's allocator take their memory from the
+  // arena and give it back when they run.
+  {
+    std::experimental::loop_scheduler s(1);
+    std::experimental::arena a;
+    int count = 0;
+    std::experimental::post(s, std::experimental::wrap(std::allocator_arg, a.get_allocator(), [&]{ ++count; }));
+    std::experimental::post(s, std::experimental::wrap(std::allocator_arg, a.get_allocator(), [&]{ ++count; }));
+    assert(a.allocations() == 2);
+    s.run();
+    assert(count == 2);
+    assert(a.allocations() == 0);
+  }
+
+  // Every hop of a chain is served by the arena, which rewinds to the same
+  // memory between hops.
+  {
+    std::experimental::thread_pool pool(2);
+    std::experimental::arena a;
+    long start = 0, end = 0;
+    hop h{pool.get_executor(), &a, 1000, &start, &end, {}};
+    std::experimental::post(pool, std::experimental::wrap(std::allocator_arg, a.get_allocator(), h));
+    pool.join();
+    assert(end == start);
+    assert(a.allocations() == 0);
+  }
+
+  // Timer wait operations and the operations that deliver their results use
+  // the arena associated with the handler.
+  {
+    std::experimental::thread_pool pool(1);
+    std::experimental::arena a;
+    std::experimental::steady_timer t(pool, std::chrono::milliseconds(1));
+    int count = 0;
+    t.wait(std::experimental::wrap(std::allocator_arg, a.get_allocator(),
+          std::experimental::wrap(pool, [&](std::error_code){ ++count; })));
+    pool.join();
+    assert(count == 1);
+    assert(a.allocations() == 0);
+  }
+
+  // The allocator is carried along a chain of continuations.
+  {
+    std::experimental::thread_pool pool(1);
+    std::experimental::arena a;
+    int result = 0;
+    std::experimental::post(pool,
+      std::experimental::wrap(std::allocator_arg, a.get_allocator(), []{ return 42; }),
+      [&](int i){ result = i; });
+    pool.join();
+    assert(result == 42);
+    assert(a.allocations() == 0);
+  }
+
+  // Allocations larger than a block, and with strict alignment, are honoured.
+  {
+    std::experimental::arena a(64);
+    std::experimental::arena_allocator<double> d(a);
+    double* p1 = d.allocate(100);
+    std::experimental::arena_allocator<char> c(a);
+    char* p2 = c.allocate(3);
+    double* p3 = d.allocate(1);
+    assert(reinterpret_cast<std::uintptr_t>(p3) % alignof(double) == 0);
+    assert(a.allocations() == 3);
+    d.deallocate(p3, 1);
+    c.deallocate(p2, 3);
+    d.deallocate(p1, 100);
+    assert(a.allocations() == 0);
+    assert(d.allocate(100) == p1);
+  }
+}
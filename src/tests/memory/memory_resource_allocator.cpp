@@ -0,0 +1,116 @@
+#include <experimental/channel>
+#include <experimental/executor>
+#include <experimental/future>
+#include <experimental/loop_scheduler>
+#include <experimental/memory>
+#include <experimental/strand>
+#include <experimental/timer>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+
+// A resource with the allocation interface of std::pmr::memory_resource.
+class counting_resource
+{
+public:
+  void* allocate(std::size_t bytes, std::size_t)
+  {
+    ++allocations;
+    ++outstanding;
+    return std::malloc(bytes);
+  }
+
+  void deallocate(void* p, std::size_t, std::size_t)
+  {
+    --outstanding;
+    std::free(p);
+  }
+
+  int allocations = 0;
+  int outstanding = 0;
+};
+
+typedef std::experimental::memory_resource_allocator<void, counting_resource> allocator_type;
+
+template <class T>
+auto with_resource(counting_resource& r, T&& t)
+{
+  return std::experimental::wrap(std::allocator_arg, allocator_type(&r), std::forward<T>(t));
+}
+
+int main()
+{
+  std::experimental::memory_resource_allocator<int, counting_resource> a1(nullptr);
+  allocator_type a2(a1);
+  assert(a1 == a2);
+  assert(!(a1 != a2));
+
+  // Posted operations, including those that run through a strand, take their
+  // memory from the resource.
+  {
+    std::experimental::loop_scheduler s(1);
+    counting_resource r;
+    int count = 0;
+    std::experimental::post(s, with_resource(r, [&]{ ++count; }));
+    std::experimental::strand<std::experimental::loop_scheduler::executor_type> st(s.get_executor());
+    std::experimental::post(st, with_resource(r, [&]{ ++count; }));
+    assert(r.allocations == 2);
+    s.run();
+    assert(count == 2);
+    assert(r.outstanding == 0);
+  }
+
+  // So do the links of a chain of continuations.
+  {
+    std::experimental::loop_scheduler s(1);
+    counting_resource r;
+    int result = 0;
+    std::experimental::post(s, with_resource(r, []{ return 1; }), [&](int i){ result = i + 1; });
+    s.run();
+    assert(result == 2);
+    assert(r.allocations > 0);
+    assert(r.outstanding == 0);
+  }
+
+  // So do timer waits and channel operations.
+  {
+    std::experimental::loop_scheduler s(1);
+    counting_resource r;
+    std::experimental::steady_timer t(s, std::chrono::milliseconds(1));
+    std::experimental::channel<int> ch(s);
+    int result = 0;
+    t.wait(with_resource(r, std::experimental::wrap(s, [&](std::error_code){
+            ch.put(42, with_resource(r, std::experimental::wrap(s, [](std::error_code){})));
+          })));
+    ch.get(with_resource(r, std::experimental::wrap(s, [&](std::error_code, int i){ result = i; })));
+    s.run();
+    assert(result == 42);
+    assert(r.allocations >= 3);
+    assert(r.outstanding == 0);
+  }
+
+  // The allocator may be attached to use_future.
+  {
+    std::experimental::loop_scheduler s(1);
+    counting_resource r;
+    std::future<int> f = std::experimental::post(s, []{ return 7; }, std::experimental::use_future[allocator_type(&r)]);
+    s.run();
+    assert(f.get() == 7);
+    assert(r.outstanding == 0);
+  }
+
+#if defined(EXECUTORS_HAS_STD_MEMORY_RESOURCE)
+  // A standard memory resource is used by default.
+  {
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource mono(buffer, sizeof(buffer));
+    std::experimental::loop_scheduler s(1);
+    int count = 0;
+    std::experimental::memory_resource_allocator<void> a(&mono);
+    for (int i = 0; i < 10; ++i)
+      std::experimental::post(s, std::experimental::wrap(std::allocator_arg, a, [&]{ ++count; }));
+    s.run();
+    assert(count == 10);
+  }
+#endif
+}
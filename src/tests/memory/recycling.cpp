@@ -0,0 +1,78 @@
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <experimental/strand>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+std::atomic<long> allocations(0);
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+struct medium { char data[200]; };
+struct large { char data[700]; };
+
+// Post a mix of operation sizes, with many outstanding at once, and run them.
+void round(std::experimental::loop_scheduler& s, int& count)
+{
+  auto ex = s.get_executor();
+  std::experimental::strand<decltype(ex)> st(ex);
+  medium m = {};
+  large l = {};
+  for (int i = 0; i < 20; ++i)
+  {
+    std::experimental::post(ex, [&count, m]{ count += 1 + m.data[0]; });
+    std::experimental::post(ex, [&count, l]{ count += 1 + l.data[0]; });
+    std::experimental::post(st, [&count]{ ++count; });
+  }
+  s.run();
+  s.restart();
+}
+
+int main()
+{
+  // Once warmed up, a workload of mixed sizes is served from recycled blocks.
+  // Only the strand created in each round needs new memory.
+  {
+    std::experimental::loop_scheduler s(1);
+    int count = 0;
+    round(s, count);
+    round(s, count);
+    long before = allocations;
+    for (int i = 0; i < 10; ++i)
+      round(s, count);
+    assert(allocations - before <= 20);
+    assert(count == 12 * 60);
+  }
+
+  // Blocks cached by a thread that exits are reused by other threads.
+  {
+    std::experimental::loop_scheduler s(1);
+    int count = 0;
+    std::thread t1([&]{ round(s, count); });
+    t1.join();
+    long used = 0;
+    std::thread t2([&]{ long before = allocations; round(s, count); used = allocations - before; });
+    t2.join();
+    assert(used <= 10);
+    assert(count == 2 * 60);
+  }
+}
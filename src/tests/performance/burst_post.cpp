@@ -0,0 +1,35 @@
+#include <experimental/loop_scheduler>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std::experimental;
+
+const int iterations = 1000000;
+
+// Measures the cost of posting bursts of small functions from the thread that
+// then runs them.
+// Usage: burst_post [burst_size]
+int main(int argc, char* argv[])
+{
+  const int burst = argc > 1 ? std::atoi(argv[1]) : 32;
+
+  loop_scheduler s(1);
+  auto ex = s.get_executor();
+  int count = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i += burst)
+  {
+    for (int j = 0; j < burst; ++j)
+      ex.post([&count]{ ++count; }, std::allocator<void>());
+    s.run();
+    s.restart();
+  }
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "time per post: ";
+  std::chrono::steady_clock::duration per_iteration = elapsed / count;
+  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(per_iteration).count();
+  std::cout << " nanoseconds\n";
+}
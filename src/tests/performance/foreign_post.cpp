@@ -0,0 +1,37 @@
+#include <experimental/loop_scheduler>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace std::experimental;
+
+const int iterations = 1000000;
+
+// Measures the cost of posting to a scheduler from a thread that is not
+// running it.
+// Usage: foreign_post [concurrency_hint]
+int main(int argc, char* argv[])
+{
+  const int hint = argc > 1 ? std::atoi(argv[1]) : 1;
+
+  loop_scheduler s(hint);
+  auto ex = s.get_executor();
+
+  std::chrono::steady_clock::duration elapsed;
+  std::thread producer([&]{
+      auto work = make_work(ex);
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i)
+        ex.post([]{}, std::allocator<void>());
+      elapsed = std::chrono::steady_clock::now() - start;
+    });
+
+  s.run();
+  producer.join();
+
+  std::cout << "time per post: ";
+  std::chrono::steady_clock::duration per_iteration = elapsed / iterations;
+  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(per_iteration).count();
+  std::cout << " nanoseconds\n";
+}
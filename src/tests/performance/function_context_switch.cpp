@@ -1,10 +1,12 @@
 #include <experimental/loop_scheduler>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std::experimental;
 
-const int chains = 4;
 const int iterations = 1000000;
 
 void chain(loop_scheduler::executor_type ex, int i)
@@ -13,16 +15,32 @@ void chain(loop_scheduler::executor_type ex, int i)
     post(wrap(ex, [=]{ chain(ex, i + 1); }));
 }
 
-int main()
+// Usage: function_context_switch [threads] [batch_size] [chains] [spin_count]
+//   [single_threaded] [next_slot_budget]
+int main(int argc, char* argv[])
 {
-  loop_scheduler s(1);
+  const int threads = argc > 1 ? std::atoi(argv[1]) : 1;
+  const int chains = argc > 3 ? std::atoi(argv[3]) : 4;
+
+  scheduler_options options;
+  options.batch_size = argc > 2 ? std::atoi(argv[2]) : 1;
+  options.spin_count = argc > 4 ? std::atoi(argv[4]) : 0;
+  options.single_threaded = argc > 5 ? std::atoi(argv[5]) != 0 : false;
+  options.next_slot_budget = argc > 6 ? std::atoi(argv[6]) : 0;
+
+  loop_scheduler s(threads, options);
   auto ex = s.get_executor();
 
   for (int c = 0; c < chains; ++c)
     dispatch(wrap(ex, [=]{ chain(ex, 0); }));
 
   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<std::thread> runners;
+  for (int t = 1; t < threads; ++t)
+    runners.emplace_back([&]{ s.run(); });
   s.run();
+  for (auto& r: runners)
+    r.join();
   std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
 
   std::cout << "time per switch: ";
@@ -0,0 +1,77 @@
+#include <experimental/thread_pool>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+
+using namespace std::experimental;
+
+const int iterations = 1000000;
+const int in_flight = 64;
+
+std::atomic<long> allocations(0);
+
+void* operator new(std::size_t n)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+// A function too large to be stored in a thread's ring of operation slots, so
+// that each post allocates a block through the recycler.
+struct payload
+{
+  std::atomic<int>* count;
+  char data[128];
+  void operator()() { count->fetch_add(1, std::memory_order_relaxed); }
+};
+
+// Measures the cost of posting from one pool thread to be run on others, with
+// a bounded number of posts in flight, and the rate at which such posts reach
+// operator new.
+// Usage: remote_free [threads]
+int main(int argc, char* argv[])
+{
+  const int threads = argc > 1 ? std::atoi(argv[1]) : 4;
+
+  thread_pool pool(threads);
+  auto ex = pool.get_executor();
+  std::atomic<int> count(0);
+
+  std::chrono::steady_clock::duration elapsed;
+  long allocated = 0;
+  ex.post([&]{
+      long start_allocations = allocations;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i)
+      {
+        while (i - count.load(std::memory_order_relaxed) >= in_flight)
+          std::this_thread::yield();
+        ex.post(payload{&count, {}}, std::allocator<void>());
+      }
+      elapsed = std::chrono::steady_clock::now() - start;
+      allocated = allocations - start_allocations;
+    }, std::allocator<void>());
+
+  pool.join();
+
+  std::cout << "time per post: ";
+  std::chrono::steady_clock::duration per_iteration = elapsed / iterations;
+  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(per_iteration).count();
+  std::cout << " nanoseconds\n";
+  std::cout << "allocations per post: " << double(allocated) / iterations << "\n";
+}
@@ -0,0 +1,57 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <experimental/strand>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+const int strands = 16;
+const int messages = 200000;
+const int book_size = 4096;
+
+struct book
+{
+  std::experimental::strand<std::experimental::thread_pool::executor_type> strand;
+  std::vector<int> levels;
+  explicit book(std::experimental::thread_pool::executor_type ex) : strand(ex), levels(book_size) {}
+};
+
+// Each message arrives on some pool thread and updates one book under its
+// strand, touching all of the book's state.
+void run(bool affinity)
+{
+  std::experimental::scheduler_options options;
+  options.work_stealing = true;
+  options.strand_affinity = affinity;
+  std::experimental::thread_pool pool(4, options);
+
+  std::vector<std::unique_ptr<book>> books;
+  for (int i = 0; i < strands; ++i)
+    books.emplace_back(new book(pool.get_executor()));
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < messages; ++i)
+  {
+    book* b = books[(i * 7) % strands].get();
+    std::experimental::post(pool, [b, i]{
+        std::experimental::post(b->strand, [b, i]{
+            for (int& level: b->levels)
+              level += i;
+          });
+      });
+  }
+  pool.join();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  std::printf("strand_affinity=%d: time per message: %.1f ns, migrations: %llu\n",
+      affinity ? 1 : 0,
+      std::chrono::duration<double, std::nano>(elapsed).count() / messages,
+      static_cast<unsigned long long>(pool.statistics().strand_migrations));
+}
+
+int main()
+{
+  run(false);
+  run(true);
+}
@@ -0,0 +1,46 @@
+#include <experimental/timer>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+const int timers = 500000;
+const int rounds = 5;
+
+// Idle timers that are cancelled and re-armed before they ever expire, as a
+// heartbeat timer is whenever traffic arrives.
+template <class Timer>
+void run(const char* name)
+{
+  std::vector<std::unique_ptr<Timer>> t;
+  for (int i = 0; i < timers; ++i)
+  {
+    t.emplace_back(new Timer(std::chrono::seconds(30 + i % 30)));
+    t.back()->wait([](std::error_code){});
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+  {
+    for (int i = 0; i < timers; ++i)
+    {
+      t[i]->expires_after(std::chrono::seconds(30 + (i + r) % 30));
+      t[i]->wait([](std::error_code){});
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  std::printf("%s: time per re-arm: %.1f ns\n", name,
+      std::chrono::duration<double, std::nano>(elapsed).count() / (timers * rounds));
+
+  for (auto& p: t)
+    p->cancel();
+}
+
+int main()
+{
+  run<std::experimental::steady_timer>("heap");
+  run<std::experimental::basic_timer<std::chrono::steady_clock,
+    std::experimental::wheel_timer_traits<std::chrono::steady_clock>>>("wheel");
+}
@@ -0,0 +1,46 @@
+#include <experimental/priority_scheduler>
+#include <experimental/executor>
+#include <experimental/strand>
+#include <atomic>
+#include <experimental/timer>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+int main()
+{
+  std::experimental::priority_scheduler scheduler(4);
+  std::experimental::executor_work<std::experimental::priority_scheduler::executor_type>
+    w(scheduler.get_executor());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back([&]{ scheduler.run(); });
+
+  std::atomic<int> count(0);
+  for (int i = 0; i < 10000; ++i)
+    std::experimental::post(scheduler.get_executor(i % 4), [&]{ ++count; });
+
+  // Function objects on a strand are not run concurrently, whatever their
+  // priority.
+  int strand_count = 0;
+  std::experimental::strand<std::experimental::priority_scheduler::executor_type>
+    s(scheduler.get_executor(3));
+  for (int i = 0; i < 1000; ++i)
+    std::experimental::post(s, [&]{ ++strand_count; });
+
+  // Timers deliver their function objects through the executor.
+  std::atomic<int> timer_count(0);
+  std::experimental::dispatch_after(std::chrono::milliseconds(10),
+    scheduler.get_executor(1), [&]{ ++timer_count; });
+  std::experimental::dispatch_after(std::chrono::milliseconds(20),
+    scheduler.get_executor(2), [&]{ ++timer_count; w.reset(); });
+
+  for (auto& t: threads)
+    t.join();
+
+  assert(count == 10000);
+  assert(strand_count == 1000);
+  assert(timer_count == 2);
+}
@@ -0,0 +1,70 @@
+#include <experimental/priority_scheduler>
+#include <experimental/executor>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+int main()
+{
+  std::experimental::priority_scheduler scheduler(3, 0);
+  assert(scheduler.num_priorities() == 3);
+
+  auto low = scheduler.get_executor(0);
+  auto normal = scheduler.get_executor(1);
+  auto high = scheduler.get_executor(2);
+  assert(low.priority() == 0);
+  assert(high.priority() == 2);
+  assert(low == scheduler.get_executor());
+  assert(low != high);
+  assert(&high.context() == &scheduler);
+
+  bool threw = false;
+  try
+  {
+    scheduler.get_executor(3);
+  }
+  catch (std::out_of_range&)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  std::vector<int> order;
+  std::experimental::post(low, [&]{ order.push_back(0); });
+  std::experimental::post(normal, [&]{ order.push_back(1); });
+  std::experimental::post(high, [&]{ order.push_back(2); });
+  std::experimental::post(low, [&]{ order.push_back(3); });
+  std::experimental::post(high, [&]{ order.push_back(4); });
+  std::experimental::post(normal, [&]{ order.push_back(5); });
+
+  assert(scheduler.run() == 6);
+  assert((order == std::vector<int>{ 2, 4, 1, 5, 0, 3 }));
+
+  // Work posted from a running function object takes its place in priority
+  // order, and dispatch runs immediately.
+  order.clear();
+  scheduler.restart();
+  std::experimental::post(low,
+    [&]
+    {
+      order.push_back(0);
+      std::experimental::post(low, [&]{ order.push_back(1); });
+      std::experimental::post(high, [&]{ order.push_back(2); });
+      std::experimental::dispatch(normal, [&]{ order.push_back(3); });
+    });
+
+  assert(scheduler.run() == 3);
+  assert((order == std::vector<int>{ 0, 3, 2, 1 }));
+
+  // Limited runs.
+  order.clear();
+  scheduler.restart();
+  std::experimental::post(low, [&]{ order.push_back(0); });
+  std::experimental::post(high, [&]{ order.push_back(1); });
+  assert(scheduler.poll_one() == 1);
+  assert((order == std::vector<int>{ 1 }));
+  assert(scheduler.run_one() == 1);
+  assert((order == std::vector<int>{ 1, 0 }));
+  assert(scheduler.poll() == 0);
+  assert(scheduler.stopped());
+}
@@ -0,0 +1,40 @@
+#include <experimental/priority_scheduler>
+#include <experimental/executor>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+int main()
+{
+  std::experimental::priority_scheduler scheduler(2, 4);
+  auto low = scheduler.get_executor(0);
+  auto high = scheduler.get_executor(1);
+
+  std::vector<int> order;
+  std::experimental::post(low, [&]{ order.push_back(0); });
+  for (int i = 1; i <= 10; ++i)
+    std::experimental::post(high, [&order, i]{ order.push_back(i); });
+
+  assert(scheduler.run() == 11);
+
+  // The low priority function object is passed over four times, then runs
+  // ahead of the remaining high priority ones.
+  assert((order == std::vector<int>{ 1, 2, 3, 4, 0, 5, 6, 7, 8, 9, 10 }));
+
+  // A continuously replenished high priority lane cannot starve the low one.
+  int high_count = 0;
+  int low_count = 0;
+  int high_when_low_ran = -1;
+  scheduler.restart();
+  std::function<void()> spin = [&]
+  {
+    if (++high_count < 100)
+      std::experimental::post(high, spin);
+  };
+  std::experimental::post(high, spin);
+  std::experimental::post(low, [&]{ ++low_count; high_when_low_ran = high_count; });
+
+  scheduler.run();
+  assert(low_count == 1);
+  assert(high_when_low_ran < 100);
+}
@@ -0,0 +1,107 @@
+#define EXECUTORS_ENABLE_STATISTICS 1
+
+#include <experimental/strand>
+#include <experimental/executor>
+#include <experimental/loop_scheduler>
+#include <cassert>
+#include <chrono>
+#include <numeric>
+#include <string>
+#include <thread>
+
+typedef std::experimental::strand<std::experimental::loop_scheduler::executor_type> loop_strand;
+
+int main()
+{
+  // Without limits a strand runs everything waiting before other work.
+  {
+    std::experimental::loop_scheduler scheduler;
+    loop_strand s(scheduler.get_executor());
+    std::string order;
+    for (int i = 0; i < 8; ++i)
+      std::experimental::post(s, [&]{ order += 's'; });
+    std::experimental::post(scheduler, [&]{ order += 'x'; });
+    scheduler.run();
+    assert(order == "ssssssssx");
+  }
+
+  // A strand limited to a number of function objects lets other work run in
+  // between batches.
+  {
+    std::experimental::loop_scheduler scheduler;
+    std::experimental::strand_options options;
+    options.max_operations = 4;
+    loop_strand s(scheduler.get_executor(), options);
+    std::string order;
+    for (int i = 0; i < 20; ++i)
+      std::experimental::post(s, [&]{ order += 's'; });
+    std::experimental::post(scheduler, [&]{ order += 'x'; });
+    scheduler.run();
+    assert(order == "ssssxssssssssssssssss");
+
+    std::experimental::strand_statistics stats = s.statistics();
+    assert(stats.operations_executed == 20);
+    assert(stats.invocations == 5);
+    assert(stats.reschedules == 4);
+    assert(stats.limit_reached == 4);
+    assert(stats.max_waiting == 20);
+    assert(stats.average_waiting == 4.0);
+    assert(stats.enqueue_to_start.count == 20);
+    assert(std::accumulate(stats.enqueue_to_start.buckets.begin(),
+          stats.enqueue_to_start.buckets.end(), uint64_t(0)) == 20);
+  }
+
+  // A strand limited by time gives up its thread once the limit has passed.
+  {
+    std::experimental::loop_scheduler scheduler;
+    std::experimental::strand_options options;
+    options.max_time = std::chrono::milliseconds(1);
+    loop_strand s(scheduler.get_executor(), options);
+    std::string order;
+    for (int i = 0; i < 3; ++i)
+      std::experimental::post(s, [&]{ order += 's'; std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+    std::experimental::post(scheduler, [&]{ order += 'x'; });
+    scheduler.run();
+    assert(order == "sxss");
+    assert(s.statistics().limit_reached == 2);
+  }
+
+  // Function objects that arrive while a strand is running cause it to be
+  // rescheduled, and each run picks up everything that was waiting.
+  {
+    std::experimental::loop_scheduler scheduler;
+    loop_strand s(scheduler.get_executor());
+    int count = 0;
+    std::experimental::post(s, [&]{
+        ++count;
+        for (int i = 0; i < 3; ++i)
+          std::experimental::post(s, [&]{ ++count; });
+      });
+    scheduler.run();
+    assert(count == 4);
+
+    std::experimental::strand_statistics stats = s.statistics();
+    assert(stats.operations_executed == 4);
+    assert(stats.invocations == 2);
+    assert(stats.reschedules == 1);
+    assert(stats.limit_reached == 0);
+    assert(stats.max_waiting == 3);
+    assert(stats.average_waiting == 2.0);
+  }
+
+  // Strands in a pool share the pool's options.
+  {
+    std::experimental::loop_scheduler scheduler;
+    std::experimental::strand_options options;
+    options.max_operations = 1;
+    std::experimental::strand_pool<std::experimental::loop_scheduler::executor_type> pool(scheduler.get_executor(), 2, options);
+    std::string order;
+    for (int i = 0; i < 3; ++i)
+    {
+      std::experimental::post(pool.get_strand(0), [&]{ order += 'a'; });
+      std::experimental::post(pool.get_strand(1), [&]{ order += 'b'; });
+    }
+    scheduler.run();
+    assert(order == "ababab");
+  }
+}
@@ -0,0 +1,54 @@
+#include <experimental/strand>
+#include <experimental/executor>
+#include <experimental/thread_pool>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+const int producers = 8;
+const int posts_per_producer = 5000;
+
+int main()
+{
+  // Operations posted to one strand from many threads never run concurrently,
+  // and each thread's operations run in the order that thread posted them.
+  std::experimental::thread_pool pool(4);
+  auto ex = make_strand(pool.get_executor());
+
+  std::atomic<int> running(0);
+  bool overlapped = false;
+  bool in_order = true;
+  std::vector<int> next(producers, 0);
+  int count = 0;
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p)
+  {
+    threads.emplace_back([&, p]{
+        for (int i = 0; i < posts_per_producer; ++i)
+        {
+          auto f = [&, p, i]{
+              overlapped = overlapped || ++running != 1;
+              in_order = in_order && next[p]++ == i;
+              ++count;
+              --running;
+            };
+          if (i % 3 == 0)
+            std::experimental::dispatch(ex, f);
+          else if (i % 3 == 1)
+            std::experimental::post(ex, f);
+          else
+            std::experimental::defer(ex, f);
+        }
+      });
+  }
+
+  for (auto& t: threads)
+    t.join();
+  pool.join();
+
+  assert(!overlapped);
+  assert(in_order);
+  assert(count == producers * posts_per_producer);
+}
@@ -0,0 +1,100 @@
+#include <experimental/strand>
+#include <experimental/executor>
+#include <experimental/thread_pool>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::atomic<int> allocations(0);
+std::atomic<int> deallocations(0);
+
+template <class T>
+struct counting_allocator
+{
+  typedef T value_type;
+  counting_allocator() {}
+  template <class U> counting_allocator(const counting_allocator<U>&) {}
+  T* allocate(std::size_t n) { ++allocations; return std::allocator<T>().allocate(n); }
+  void deallocate(T* p, std::size_t n) { ++deallocations; std::allocator<T>().deallocate(p, n); }
+  template <class U> struct rebind { typedef counting_allocator<U> other; };
+};
+
+template <class T, class U>
+bool operator==(const counting_allocator<T>&, const counting_allocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const counting_allocator<T>&, const counting_allocator<U>&) { return false; }
+
+int main()
+{
+  // A key always selects the same strand, and the selected strands serialise
+  // the work submitted for each key.
+  {
+    std::experimental::thread_pool pool(4);
+    std::experimental::strand_pool<std::experimental::thread_pool::executor_type> strands(pool.get_executor(), 8);
+    assert(strands.size() == 8);
+    assert(strands.get_strand_for(std::string("ABC")) == strands.get_strand_for(std::string("ABC")));
+    assert(strands.get_strand(3) == strands.get_strand(11));
+    assert(strands.get_strand(3) != strands.get_strand(4));
+
+    const int keys = 32;
+    std::vector<std::atomic<int>> running(8);
+    std::vector<int> counts(keys, 0);
+    std::atomic<bool> overlapped(false);
+    for (int i = 0; i < 100; ++i)
+    {
+      for (int k = 0; k < keys; ++k)
+      {
+        auto s = strands.get_strand_for(k);
+        std::experimental::post(s, [&, k]{
+            if (++running[k % 8] != 1)
+              overlapped = true;
+            ++counts[k];
+            --running[k % 8];
+          });
+      }
+    }
+    pool.join();
+    assert(!overlapped);
+    for (int k = 0; k < keys; ++k)
+      assert(counts[k] == 100);
+  }
+
+  // An ad hoc strand may be given an allocator for its implementation.
+  {
+    std::experimental::thread_pool pool(1);
+    {
+      std::experimental::strand<std::experimental::thread_pool::executor_type> s(
+          std::allocator_arg, counting_allocator<void>(), pool.get_executor());
+      assert(allocations == 1);
+      int count = 0;
+      std::experimental::post(s, [&count]{ ++count; });
+      pool.join();
+      assert(count == 1);
+    }
+    assert(deallocations == 1);
+  }
+
+  // Strands created and destroyed concurrently on many threads all work.
+  {
+    std::experimental::thread_pool pool(4);
+    std::atomic<int> count(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+      threads.emplace_back([&]{
+          for (int i = 0; i < 1000; ++i)
+          {
+            auto s = make_strand(pool.get_executor());
+            std::experimental::post(s, [&count]{ ++count; });
+          }
+        });
+    }
+    for (auto& t: threads)
+      t.join();
+    pool.join();
+    assert(count == 8000);
+  }
+}
@@ -0,0 +1,163 @@
+#include <experimental/shared_strand>
+#include <experimental/executor>
+#include <experimental/loop_scheduler>
+#include <experimental/thread_pool>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+std::atomic<int> live(0);
+
+struct counted
+{
+  counted() { ++live; }
+  counted(const counted&) { ++live; }
+  ~counted() { --live; }
+};
+
+typedef std::experimental::shared_strand<std::experimental::thread_pool::executor_type> pool_strand;
+
+int main()
+{
+  // Shared function objects run concurrently with each other.
+  {
+    std::experimental::thread_pool pool(4);
+    pool_strand s(pool.get_executor());
+    std::atomic<int> arrived(0);
+    std::atomic<bool> all_arrived(false);
+    for (int i = 0; i < 4; ++i)
+    {
+      std::experimental::post(s.get_shared_executor(), [&]{
+          ++arrived;
+          auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+          while (arrived < 4 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+          if (arrived == 4)
+            all_arrived = true;
+        });
+    }
+    pool.join();
+    assert(all_arrived);
+  }
+
+  // Exclusive function objects run alone, and everything starts in the order
+  // in which it was submitted.
+  {
+    std::experimental::thread_pool pool(4);
+    pool_strand s(pool.get_executor());
+    std::atomic<int> readers(0);
+    std::atomic<int> writers(0);
+    std::atomic<bool> overlapped(false);
+    std::mutex mutex;
+    std::vector<int> started;
+    for (int i = 0; i < 2000; ++i)
+    {
+      bool exclusive = i % 5 == 0;
+      auto ex = exclusive ? s.get_exclusive_executor() : s.get_shared_executor();
+      std::experimental::post(ex, [&, i, exclusive]{
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            started.push_back(i);
+          }
+          if (exclusive)
+          {
+            if (++writers != 1 || readers != 0)
+              overlapped = true;
+            --writers;
+          }
+          else
+          {
+            ++readers;
+            if (writers != 0)
+              overlapped = true;
+            --readers;
+          }
+        });
+    }
+    pool.join();
+    assert(!overlapped);
+    assert(started.size() == 2000);
+
+    // A function object may start ahead of one submitted before it only when
+    // both are shared and no exclusive one lies between them.
+    for (size_t i = 0; i < started.size(); ++i)
+    {
+      if (started[i] % 5 == 0)
+      {
+        for (size_t j = 0; j < i; ++j)
+          assert(started[j] < started[i]);
+        for (size_t j = i + 1; j < started.size(); ++j)
+          assert(started[j] > started[i]);
+      }
+    }
+  }
+
+  // An exclusive function object waits for running shared ones, and shared
+  // ones submitted after it wait for it to finish.
+  {
+    std::experimental::thread_pool pool(4);
+    pool_strand s(pool.get_executor());
+    std::atomic<bool> release(false);
+    std::mutex mutex;
+    std::vector<char> order;
+    auto record = [&](char c){ std::lock_guard<std::mutex> lock(mutex); order.push_back(c); };
+    std::experimental::post(s.get_shared_executor(), [&]{
+        while (!release)
+          std::this_thread::yield();
+        record('a');
+      });
+    std::experimental::post(s.get_exclusive_executor(), [&]{ record('w'); });
+    std::experimental::post(s.get_shared_executor(), [&]{ record('b'); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+    pool.join();
+    assert(order == std::vector<char>({'a', 'w', 'b'}));
+  }
+
+  // Dispatch runs a function object immediately only when the calling thread
+  // already holds the strand in a compatible mode.
+  {
+    std::experimental::loop_scheduler scheduler;
+    std::experimental::shared_strand<std::experimental::loop_scheduler::executor_type> s(scheduler.get_executor());
+    auto shared = s.get_shared_executor();
+    auto exclusive = s.get_exclusive_executor();
+    assert(shared != exclusive);
+    assert(shared == s.get_shared_executor());
+    assert(!shared.running_in_this_thread());
+    std::vector<int> order;
+    std::experimental::post(exclusive, [&]{
+        assert(shared.running_in_this_thread());
+        assert(exclusive.running_in_this_thread());
+        std::experimental::dispatch(shared, [&]{ order.push_back(1); });
+        std::experimental::dispatch(exclusive, [&]{ order.push_back(2); });
+        order.push_back(3);
+      });
+    std::experimental::post(shared, [&]{
+        assert(shared.running_in_this_thread());
+        assert(!exclusive.running_in_this_thread());
+        std::experimental::dispatch(shared, [&]{ order.push_back(4); });
+        std::experimental::dispatch(exclusive, [&]{ order.push_back(6); });
+        order.push_back(5);
+      });
+    scheduler.run();
+    assert(order == std::vector<int>({1, 2, 3, 4, 5, 6}));
+  }
+
+  // Function objects that never run are destroyed on shutdown.
+  {
+    {
+      std::experimental::loop_scheduler scheduler;
+      std::experimental::shared_strand<std::experimental::loop_scheduler::executor_type> s(scheduler.get_executor());
+      counted c;
+      for (int i = 0; i < 10; ++i)
+      {
+        std::experimental::post(s.get_exclusive_executor(), [c]{});
+        std::experimental::post(s.get_shared_executor(), [c]{});
+      }
+    }
+    assert(live == 0);
+  }
+}
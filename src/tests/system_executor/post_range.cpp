@@ -0,0 +1,27 @@
+#include <experimental/executor>
+#include <experimental/future>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <vector>
+
+int main()
+{
+  std::experimental::system_executor ex;
+
+  std::vector<std::promise<int>> promises(10);
+  std::vector<std::function<void()>> handlers;
+  for (int i = 0; i < 10; ++i)
+    handlers.push_back([&promises, i]{ promises[i].set_value(i); });
+  ex.post_range(handlers.begin(), handlers.end(), std::allocator<void>());
+
+  for (int i = 0; i < 10; ++i)
+    assert(promises[i].get_future().get() == i);
+
+  std::promise<int> p1, p2;
+  ex.post_each(std::allocator<void>(),
+    [&]{ p1.set_value(1); },
+    [&]{ p2.set_value(2); });
+  assert(p1.get_future().get() == 1);
+  assert(p2.get_future().get() == 2);
+}
@@ -0,0 +1,77 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+std::mutex mutex;
+std::condition_variable condition;
+int arrived = 0;
+std::atomic<int> rendezvous_count(0);
+std::atomic<int> rendezvous_failures(0);
+
+// Completes only if n handlers are running at the same time, which requires
+// the pool to have grown to at least n threads.
+void rendezvous(int n)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  ++arrived;
+  condition.notify_all();
+  if (!condition.wait_for(lock, std::chrono::seconds(10), [n]{ return arrived >= n; }))
+    ++rendezvous_failures;
+  ++rendezvous_count;
+}
+
+void grow_to(std::experimental::thread_pool& pool, int n)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    arrived = 0;
+  }
+  rendezvous_count = 0;
+
+  for (int i = 0; i < n; ++i)
+  {
+    std::experimental::post(pool, [n]{ rendezvous(n); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  while (rendezvous_count < n)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  assert(rendezvous_failures == 0);
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  options.max_threads = 4;
+  options.grow_queue_depth = 2;
+  options.grow_latency = std::chrono::milliseconds(1);
+  options.idle_timeout = std::chrono::milliseconds(50);
+
+  {
+    std::experimental::thread_pool pool(1, options);
+    grow_to(pool, 4);
+
+    // Let the extra threads retire, then grow again.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    grow_to(pool, 4);
+
+    std::atomic<int> count(0);
+    for (int i = 0; i < 1000; ++i)
+      std::experimental::post(pool, [&count]{ ++count; });
+    pool.join();
+    assert(count == 1000);
+  }
+
+  {
+    options.work_stealing = true;
+    std::experimental::thread_pool pool(2, options);
+    grow_to(pool, 3);
+
+    // Destroy the pool while the extra thread is still running.
+  }
+}
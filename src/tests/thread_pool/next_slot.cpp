@@ -0,0 +1,58 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <experimental/future>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <future>
+#include <thread>
+
+int follow_up()
+{
+  return 42;
+}
+
+void block_on_follow_up(const std::experimental::scheduler_options& options)
+{
+  std::experimental::thread_pool pool(4, options);
+
+  // A handler that blocks until its follow-up has run must not hold the
+  // follow-up in its slot while other threads are idle.
+  for (int i = 0; i < 100; ++i)
+  {
+    std::future<int> f = std::experimental::post(pool, [&pool]{
+        return std::experimental::post(pool, follow_up, std::experimental::use_future).get();
+      }, std::experimental::use_future);
+    assert(f.get() == 42);
+  }
+
+  // Likewise when the other threads are busy at the time of the post, and only
+  // go idle afterwards.
+  for (int i = 0; i < 10; ++i)
+  {
+    std::atomic<int> started(0);
+    for (int j = 0; j < 3; ++j)
+      std::experimental::post(pool, [&started]{
+          ++started;
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        });
+    std::future<int> f = std::experimental::post(pool, [&pool, &started]{
+        while (started < 3)
+          std::this_thread::yield();
+        return std::experimental::post(pool, follow_up, std::experimental::use_future).get();
+      }, std::experimental::use_future);
+    assert(f.get() == 42);
+  }
+
+  pool.join();
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  options.next_slot_budget = 8;
+  block_on_follow_up(options);
+
+  options.work_stealing = true;
+  block_on_follow_up(options);
+}
@@ -0,0 +1,54 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <future>
+
+#if defined(__linux__)
+# include <sched.h>
+#endif
+
+void run(const std::experimental::scheduler_options& options)
+{
+  std::experimental::thread_pool pool(4, options);
+  auto ex = pool.get_executor();
+
+  std::atomic<int> count(0);
+  for (int i = 0; i < 1000; ++i)
+    std::experimental::post(ex, [&count]{ ++count; });
+
+  pool.join();
+  assert(count == 1000);
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  run(options);
+
+  options.placement = std::experimental::thread_placement::physical_core;
+  run(options);
+
+  options.placement = std::experimental::thread_placement::numa_node;
+  run(options);
+
+  options.work_stealing = true;
+  options.numa_local_queues = true;
+  run(options);
+
+#if defined(__linux__)
+  // Bind every thread to the processor the main thread is running on, which
+  // is known to be available to this process.
+  int cpu = sched_getcpu();
+  if (cpu >= 0)
+  {
+    options.placement = std::experimental::thread_placement::cpu_list;
+    options.cpus.assign(1, static_cast<unsigned>(cpu));
+
+    std::experimental::thread_pool pool(2, options);
+    std::promise<int> p;
+    std::experimental::post(pool, [&p]{ p.set_value(sched_getcpu()); });
+    assert(p.get_future().get() == cpu);
+  }
+#endif
+}
@@ -0,0 +1,49 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <vector>
+
+std::atomic<int> count(0);
+
+void fan_out(std::experimental::thread_pool::executor_type ex, int depth)
+{
+  assert(ex.running_in_this_thread());
+  ++count;
+  if (depth > 0)
+  {
+    ex.post_each(std::allocator<void>(),
+      [=]{ fan_out(ex, depth - 1); },
+      [=]{ fan_out(ex, depth - 1); });
+  }
+}
+
+void run(const std::experimental::scheduler_options& options)
+{
+  count = 0;
+
+  std::experimental::thread_pool pool(4, options);
+  auto ex = pool.get_executor();
+
+  std::vector<std::function<void()>> handlers;
+  for (int i = 0; i < 100; ++i)
+    handlers.push_back([=]{ fan_out(ex, 5); });
+
+  ex.post_range(handlers.begin(), handlers.end(), std::allocator<void>());
+  ex.post_range(handlers.end(), handlers.end(), std::allocator<void>());
+  ex.post_each(std::allocator<void>());
+
+  pool.join();
+  assert(count == 100 * ((1 << 6) - 1));
+}
+
+int main()
+{
+  run(std::experimental::scheduler_options());
+
+  std::experimental::scheduler_options options;
+  options.work_stealing = true;
+  run(options);
+}
@@ -0,0 +1,48 @@
+#include <experimental/thread_pool>
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <future>
+
+void ping_pong(const std::experimental::scheduler_options& options)
+{
+  std::experimental::thread_pool pool(2, options);
+  auto ex = pool.get_executor();
+
+  // Each round trip leaves the pool idle, so the next post has to find a
+  // thread that is either still spinning or has parked.
+  for (int i = 0; i < 1000; ++i)
+  {
+    std::promise<int> p;
+    std::experimental::post(ex, [&p, i]{ p.set_value(i); });
+    assert(p.get_future().get() == i);
+  }
+
+  std::atomic<int> count(0);
+  for (int i = 0; i < 1000; ++i)
+    std::experimental::post(ex, [&count]{ ++count; });
+
+  pool.join();
+  assert(count == 1000);
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  options.spin_count = 1000;
+  options.yield_count = 10;
+  ping_pong(options);
+
+  options.work_stealing = true;
+  ping_pong(options);
+
+  options.spin_count = 0;
+  ping_pong(options);
+
+  // A spinning thread still honours the deadline of a timed run.
+  std::experimental::loop_scheduler s(1, options);
+  auto work = std::experimental::make_work(s);
+  assert(s.run_for(std::chrono::milliseconds(10)) == 0);
+}
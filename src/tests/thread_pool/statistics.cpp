@@ -0,0 +1,61 @@
+#define EXECUTORS_ENABLE_STATISTICS 1
+
+#include <experimental/thread_pool>
+#include <experimental/loop_scheduler>
+#include <experimental/executor>
+#include <experimental/future>
+#include <cassert>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+void check_histogram(const std::experimental::scheduler_histogram& h, uint64_t count)
+{
+  assert(h.count == count);
+  assert(std::accumulate(h.buckets.begin(), h.buckets.end(), uint64_t(0)) == count);
+}
+
+int main()
+{
+  {
+    std::experimental::thread_pool pool(2);
+    for (int i = 0; i < 100; ++i)
+      std::experimental::post(pool, []{});
+    std::experimental::post(pool, []{ std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+    pool.join();
+
+    std::experimental::scheduler_statistics stats = pool.statistics();
+    assert(stats.queue_depth == 0);
+    assert(stats.operations_executed == 101);
+    assert(std::accumulate(stats.operations_executed_per_thread.begin(),
+          stats.operations_executed_per_thread.end(), uint64_t(0)) == 101);
+    check_histogram(stats.enqueue_to_start, 101);
+    check_histogram(stats.execution_time, 101);
+    assert(stats.execution_time.total >= std::chrono::milliseconds(10));
+    check_histogram(stats.lock_wait, stats.lock_wait.count);
+  }
+
+  {
+    std::experimental::loop_scheduler scheduler;
+    for (int i = 0; i < 10; ++i)
+      std::experimental::post(scheduler, []{});
+    assert(scheduler.statistics().queue_depth == 10);
+    scheduler.run();
+
+    std::experimental::scheduler_statistics stats = scheduler.statistics();
+    assert(stats.queue_depth == 0);
+    assert(stats.operations_executed == 10);
+    assert(stats.operations_executed_per_thread.size() == 1);
+    check_histogram(stats.enqueue_to_start, 10);
+    check_histogram(stats.execution_time, 10);
+  }
+
+  {
+    std::experimental::system_executor ex;
+    uint64_t before = ex.statistics().operations_executed;
+    std::future<void> f = std::experimental::post(ex, []{}, std::experimental::use_future);
+    f.get();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    assert(ex.statistics().operations_executed >= before + 1);
+  }
+}
@@ -0,0 +1,89 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <experimental/strand>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+// Run a chain of operations on a strand, some submitted from outside the pool
+// and some from within, and check that every change of thread between
+// consecutive operations is counted as a migration.
+void check_migrations(bool affinity)
+{
+  std::experimental::scheduler_options options;
+  options.work_stealing = true;
+  options.strand_affinity = affinity;
+  std::experimental::thread_pool pool(4, options);
+  auto s = make_strand(pool.get_executor());
+
+  std::vector<std::thread::id> threads;
+  std::atomic<int> count(0);
+  for (int i = 0; i < 2000; ++i)
+  {
+    std::experimental::post(s, [&, i]{
+        threads.push_back(std::this_thread::get_id());
+        ++count;
+        if (i % 2 == 0)
+          std::experimental::post(pool, [&]{
+              std::experimental::post(s, [&]{
+                  threads.push_back(std::this_thread::get_id());
+                  ++count;
+                });
+            });
+      });
+    if (i % 100 == 0)
+      while (count <= i)
+        std::this_thread::yield();
+  }
+  pool.join();
+
+  uint64_t migrations = 0;
+  for (size_t i = 1; i < threads.size(); ++i)
+    if (threads[i] != threads[i - 1])
+      ++migrations;
+
+  assert(threads.size() == 3000);
+  assert(pool.statistics().strand_migrations == migrations);
+}
+
+int main()
+{
+  check_migrations(false);
+  check_migrations(true);
+
+  // Strands run with affinity still never run their operations concurrently.
+  {
+    std::experimental::scheduler_options options;
+    options.work_stealing = true;
+    options.strand_affinity = true;
+    std::experimental::thread_pool pool(4, options);
+
+    const int strands = 8;
+    std::vector<std::experimental::strand<std::experimental::thread_pool::executor_type>> s;
+    for (int i = 0; i < strands; ++i)
+      s.emplace_back(pool.get_executor());
+
+    std::vector<std::atomic<int>> running(strands);
+    std::vector<int> counts(strands, 0);
+    std::atomic<bool> overlapped(false);
+    for (int i = 0; i < 1000; ++i)
+    {
+      for (int j = 0; j < strands; ++j)
+      {
+        std::experimental::post(pool, [&, j]{
+            std::experimental::dispatch(s[j], [&, j]{
+                if (++running[j] != 1)
+                  overlapped = true;
+                ++counts[j];
+                --running[j];
+              });
+          });
+      }
+    }
+    pool.join();
+    assert(!overlapped);
+    for (int j = 0; j < strands; ++j)
+      assert(counts[j] == 1000);
+  }
+}
@@ -0,0 +1,38 @@
+#include <experimental/thread_pool>
+#include <experimental/executor>
+#include <atomic>
+#include <cassert>
+
+std::atomic<int> count(0);
+std::atomic<int> foreign_count(0);
+
+void fan_out(std::experimental::thread_pool::executor_type ex, int depth)
+{
+  assert(ex.running_in_this_thread());
+  ++count;
+  if (depth > 0)
+  {
+    std::experimental::post(ex, [=]{ fan_out(ex, depth - 1); });
+    std::experimental::defer(ex, [=]{ fan_out(ex, depth - 1); });
+  }
+}
+
+int main()
+{
+  std::experimental::scheduler_options options;
+  options.work_stealing = true;
+  std::experimental::thread_pool pool(4, options);
+  auto ex = pool.get_executor();
+
+  assert(!ex.running_in_this_thread());
+
+  for (int i = 0; i < 8; ++i)
+    std::experimental::post(ex, [=]{ fan_out(ex, 10); });
+
+  for (int i = 0; i < 1000; ++i)
+    std::experimental::post(ex, []{ ++foreign_count; });
+
+  pool.join();
+  assert(count == 8 * ((1 << 11) - 1));
+  assert(foreign_count == 1000);
+}
@@ -0,0 +1,171 @@
+#include <experimental/loop_scheduler>
+#include <experimental/thread_pool>
+#include <experimental/timer>
+#include <experimental/future>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using std::experimental::loop_scheduler;
+using std::experimental::scheduler_options;
+using std::experimental::steady_timer;
+using std::experimental::thread_pool;
+using std::experimental::wrap;
+
+std::atomic<int> success_count;
+std::atomic<int> cancel_count;
+
+template <class Executor>
+struct handler
+{
+  Executor ex;
+  std::chrono::steady_clock::time_point expiry;
+
+  void operator()(std::error_code ec)
+  {
+    assert(ex.running_in_this_thread());
+    if (ec == std::errc::operation_canceled)
+      ++cancel_count;
+    else if (!ec)
+    {
+      assert(std::chrono::steady_clock::now() >= expiry);
+      ++success_count;
+    }
+  }
+};
+
+template <class Executor>
+handler<Executor> make_handler(const Executor& ex, const steady_timer& t)
+{
+  return handler<Executor>{ex, t.expiry()};
+}
+
+void test_run(const scheduler_options& options)
+{
+  success_count = 0;
+
+  // Timers expire in order on the thread that runs the scheduler, which
+  // returns once they have all completed.
+  loop_scheduler s(1, options);
+  auto ex = s.get_executor();
+  std::vector<int> order;
+  auto start = std::chrono::steady_clock::now();
+  steady_timer t1(s, std::chrono::milliseconds(30));
+  steady_timer t2(s, std::chrono::milliseconds(10));
+  steady_timer t3(s, std::chrono::milliseconds(20));
+  t1.wait(wrap(ex, [&](std::error_code){ order.push_back(1); }));
+  t2.wait(wrap(ex, [&](std::error_code){ order.push_back(2); }));
+  t3.wait(wrap(ex, [&](std::error_code){ order.push_back(3); }));
+  t1.wait(wrap(ex, make_handler(ex, t1)));
+
+  s.run();
+  assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(30));
+  assert((order == std::vector<int>{ 2, 3, 1 }));
+  assert(success_count == 1);
+}
+
+void test_run_for(const scheduler_options& options)
+{
+  loop_scheduler s(1, options);
+  auto ex = s.get_executor();
+  int count = 0;
+  steady_timer t(s, std::chrono::milliseconds(50));
+  t.wait(wrap(ex, [&](std::error_code){ ++count; }));
+
+  // A run that ends before the expiry does not run the timer.
+  assert(s.run_for(std::chrono::milliseconds(5)) == 0);
+  assert(s.poll() == 0);
+  assert(count == 0);
+
+  // Once expired, the wait and then the handler run.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  s.poll();
+  s.run_for(std::chrono::milliseconds(100));
+  assert(count == 1);
+}
+
+void test_cancel(const scheduler_options& options)
+{
+  cancel_count = 0;
+
+  // Cancelling a timer wakes the waiting thread.
+  loop_scheduler s(1, options);
+  auto ex = s.get_executor();
+  steady_timer t(s, std::chrono::seconds(60));
+  t.wait(wrap(ex, make_handler(ex, t)));
+
+  std::thread canceller([&]{
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      t.cancel();
+    });
+  auto start = std::chrono::steady_clock::now();
+  s.run();
+  assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(30));
+  assert(cancel_count == 1);
+  canceller.join();
+}
+
+void test_busy(const scheduler_options& options)
+{
+  // Timers expire while the scheduler is never idle.
+  loop_scheduler s(1, options);
+  auto ex = s.get_executor();
+  std::atomic<bool> expired(false);
+  steady_timer t(s, std::chrono::milliseconds(20));
+  t.wait(wrap(ex, [&](std::error_code){ expired = true; }));
+
+  std::function<void()> spin;
+  spin = [&]{ if (!expired) std::experimental::post(ex, spin); };
+  std::experimental::post(ex, spin);
+  s.run();
+  assert(expired);
+}
+
+void test_thread_pool()
+{
+  success_count = 0;
+
+  scheduler_options options;
+  options.run_timers = true;
+  thread_pool pool(2, options);
+  auto ex = pool.get_executor();
+  std::vector<std::unique_ptr<steady_timer>> timers;
+  for (int i = 0; i < 100; ++i)
+  {
+    timers.emplace_back(new steady_timer(pool, std::chrono::milliseconds(i % 20)));
+    timers.back()->wait(wrap(ex, make_handler(ex, *timers.back())));
+  }
+
+  steady_timer last(pool, std::chrono::milliseconds(40));
+  last.wait(wrap(ex, std::experimental::use_future)).get();
+  while (success_count < 100)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  timers.clear();
+  pool.join();
+}
+
+int main()
+{
+  scheduler_options options;
+  options.run_timers = true;
+
+  scheduler_options single_threaded(options);
+  single_threaded.single_threaded = true;
+
+  scheduler_options work_stealing(options);
+  work_stealing.work_stealing = true;
+
+  for (auto& o: { options, single_threaded, work_stealing })
+  {
+    test_run(o);
+    test_run_for(o);
+    test_cancel(o);
+    test_busy(o);
+  }
+
+  test_thread_pool();
+}
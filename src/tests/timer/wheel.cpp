@@ -0,0 +1,128 @@
+#include <experimental/timer>
+#include <experimental/future>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::experimental::basic_timer<std::chrono::steady_clock,
+  std::experimental::wheel_timer_traits<std::chrono::steady_clock>> wheel_timer;
+
+typedef std::experimental::basic_timer<std::chrono::steady_clock,
+  std::experimental::wheel_timer_traits<std::chrono::steady_clock,
+    std::chrono::microseconds>> fine_wheel_timer;
+
+std::atomic<int> success_count;
+std::atomic<int> cancel_count;
+std::atomic<int> early_count;
+
+struct handler
+{
+  std::chrono::steady_clock::time_point expiry;
+
+  void operator()(std::error_code ec)
+  {
+    if (ec == std::errc::operation_canceled)
+      ++cancel_count;
+    else if (!ec)
+    {
+      if (std::chrono::steady_clock::now() < expiry)
+        ++early_count;
+      ++success_count;
+    }
+  }
+};
+
+template <class Timer>
+void test_many_timers()
+{
+  success_count = 0;
+  cancel_count = 0;
+  early_count = 0;
+
+  const int n = 2000;
+  std::vector<std::unique_ptr<Timer>> timers;
+  for (int i = 0; i < n; ++i)
+  {
+    if (i % 2 == 0)
+      timers.emplace_back(new Timer(std::chrono::seconds(10)));
+    else
+      timers.emplace_back(new Timer(std::chrono::milliseconds(i % 200)));
+    timers.back()->wait(handler{timers.back()->expiry()});
+  }
+
+  // Cancel and re-arm every other timer, as a heartbeat would.
+  for (int i = 0; i < n; i += 2)
+  {
+    timers[i]->cancel();
+    timers[i]->expires_after(std::chrono::milliseconds(50 + i % 100));
+    timers[i]->wait(handler{timers[i]->expiry()});
+  }
+
+  // The last timer to expire is waited for after all others.
+  Timer last(std::chrono::milliseconds(300));
+  last.wait();
+
+  while (success_count + cancel_count < n + n / 2)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  assert(success_count == n);
+  assert(cancel_count == n / 2);
+  assert(early_count == 0);
+}
+
+void test_order()
+{
+  std::vector<int> order;
+  std::mutex mutex;
+
+  fine_wheel_timer t1(std::chrono::milliseconds(30));
+  fine_wheel_timer t2(std::chrono::milliseconds(10));
+  fine_wheel_timer t3(std::chrono::milliseconds(20));
+
+  auto f1 = t1.wait(std::experimental::use_future);
+  t2.wait([&](std::error_code){ std::lock_guard<std::mutex> l(mutex); order.push_back(2); });
+  t3.wait([&](std::error_code){ std::lock_guard<std::mutex> l(mutex); order.push_back(3); });
+  f1.get();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::lock_guard<std::mutex> l(mutex);
+  assert(order.size() == 2);
+  assert(order[0] == 2);
+  assert(order[1] == 3);
+}
+
+void test_far_and_never()
+{
+  cancel_count = 0;
+
+  // Further away than the wheels can hold at a microsecond tick.
+  fine_wheel_timer far(std::chrono::hours(48));
+  far.wait(handler{far.expiry()});
+
+  // No expiry time.
+  fine_wheel_timer never;
+  never.wait(handler{never.expiry()});
+
+  // Nearer timers still expire on time.
+  auto start = std::chrono::steady_clock::now();
+  fine_wheel_timer near(std::chrono::milliseconds(20));
+  near.wait();
+  assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+
+  far.cancel();
+  never.cancel();
+  while (cancel_count < 2)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main()
+{
+  test_many_timers<wheel_timer>();
+  test_many_timers<fine_wheel_timer>();
+  test_many_timers<std::experimental::steady_timer>();
+  test_order();
+  test_far_and_never();
+}